@@ -0,0 +1,148 @@
+/*
+ * WebSocketBroadcastBenchmark.ino
+ *
+ * compares broadcastBIN (frame encoded once) with sending the frame to
+ * every client on its own (copy + header per client) and prints the
+ * results in CPU cycles
+ *
+ * the clients are simulated
+ *
+ */
+
+#include <Arduino.h>
+
+#include <ESP8266WiFi.h>
+#include <WebSocketsServer.h>
+
+#define USE_SERIAL Serial
+
+#define BENCH_ROUNDS 20
+#define BENCH_CLIENTS 50
+
+static const uint8_t clientCounts[] = { 5, 20, 50 };
+static const size_t sizes[] = { 16, 128, 512 };
+
+// discards everything, so only the library work is measured
+class NullClient : public WebSocketsTransport {
+	public:
+		int connect(const char * host, uint16_t port) {
+			return 0;
+		}
+		uint8_t connected() {
+			return 1;
+		}
+		int available() {
+			return 0;
+		}
+		int read() {
+			return -1;
+		}
+		int read(uint8_t * buf, size_t size) {
+			return 0;
+		}
+		size_t write(const uint8_t * buf, size_t size) {
+			bytes += size;
+			return size;
+		}
+		int availableForWrite() {
+			return 1460;
+		}
+		void stop() {
+		}
+		size_t bytes = 0;
+};
+
+class BenchServer : public WebSocketsServer {
+	public:
+		BenchServer() : WebSocketsServer(81, "", "arduino", BENCH_CLIENTS) {
+		}
+
+		// the library deletes the clients on disconnect
+		void attach(uint8_t count) {
+			disconnect();
+			for(uint8_t i = 0; i < count; i++) {
+				nullClients[i] = new NullClient();
+				if(newClient(nullClients[i])) {
+					clientByNum(i)->status = WSC_CONNECTED;
+				}
+			}
+		}
+
+		// the old broadcast: copy and header for every client
+		bool sendEach(uint8_t * payload, size_t length) {
+			bool ret = true;
+			for(uint8_t i = 0; i < BENCH_CLIENTS; i++) {
+				WSclient_t * client = clientByNum(i);
+				if(client && clientIsConnected(client)) {
+					uint8_t * buffer = (uint8_t *) malloc(length + WEBSOCKETS_MAX_HEADER_SIZE);
+					if(!buffer) {
+						return false;
+					}
+					memcpy(buffer + WEBSOCKETS_MAX_HEADER_SIZE, payload, length);
+					ret &= sendFrame(client, WSop_binary, buffer, length, false, true, true);
+					free(buffer);
+				}
+			}
+			return ret;
+		}
+
+		NullClient * nullClients[BENCH_CLIENTS];
+};
+
+BenchServer server;
+uint8_t payload[512];
+
+void bench(uint8_t count, size_t length) {
+	uint32_t start;
+	uint32_t each;
+	uint32_t once;
+
+	server.attach(count);
+
+	start = ESP.getCycleCount();
+	for(uint8_t r = 0; r < BENCH_ROUNDS; r++) {
+		server.sendEach(payload, length);
+	}
+	each = (ESP.getCycleCount() - start) / BENCH_ROUNDS;
+
+	start = ESP.getCycleCount();
+	for(uint8_t r = 0; r < BENCH_ROUNDS; r++) {
+		server.broadcastBIN(payload, length);
+	}
+	once = (ESP.getCycleCount() - start) / BENCH_ROUNDS;
+
+	USE_SERIAL.printf("[BENCH] clients: %2u len: %3u per client: %8u cycles encode once: %8u cycles (x%u.%02u)\n",
+			count, length, each, once, each / once, ((each * 100) / once) % 100);
+}
+
+void setup() {
+	USE_SERIAL.begin(115200);
+
+	USE_SERIAL.println();
+	USE_SERIAL.println();
+
+	WiFi.mode(WIFI_OFF);
+
+	for(size_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = random(0xFF);
+	}
+
+	// check both paths send the same bytes
+	server.attach(1);
+	server.sendEach(payload, sizeof(payload));
+	size_t eachBytes = server.nullClients[0]->bytes;
+	server.broadcastBIN(payload, sizeof(payload));
+	USE_SERIAL.printf("[BENCH] self check: %s\n", ((server.nullClients[0]->bytes - eachBytes) == eachBytes) ? "ok" : "FAIL");
+
+	for(uint8_t c = 0; c < sizeof(clientCounts); c++) {
+		for(uint8_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+			bench(clientCounts[c], sizes[i]);
+			delay(0);
+		}
+	}
+
+	server.attach(0);
+}
+
+void loop() {
+}
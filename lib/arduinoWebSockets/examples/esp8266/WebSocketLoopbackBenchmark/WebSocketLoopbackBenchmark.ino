@@ -0,0 +1,165 @@
+/*
+ * WebSocketLoopbackBenchmark.ino
+ *
+ * WebSocketsClient and WebSocketsServer in one sketch, connected by a
+ * WebSocketsLoopback pipe instead of TCP, so the whole path (handshake,
+ * masking, framing, parsing) is measured without the network
+ *
+ * prints the CPU cycles per frame in both directions and the heap
+ * allocations of the receive path (rx pool misses)
+ *
+ */
+
+#include <Arduino.h>
+
+#include <ESP8266WiFi.h>
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define USE_SERIAL Serial
+
+#define BENCH_ROUNDS 50
+#define PIPE_SIZE 8192
+
+static const size_t sizes[] = { 16, 125, 1024, 4096 };
+
+class LoopServer : public WebSocketsServer {
+	public:
+		LoopServer() : WebSocketsServer(81, "", "arduino", 1) {
+		}
+
+		bool attach(WebSocketsLoopback * pipe) {
+			return newClient(pipe);
+		}
+
+		// loop() without accepting
+		void run() {
+			clientsRelease();
+			handleClientData();
+		}
+};
+
+LoopServer server;
+
+class LoopClient : public WebSocketsClient {
+	protected:
+		// every connect gets a new pipe, the other end goes to the server
+		WebSocketsTransport * createTransport() {
+			WebSocketsLoopback * end = new WebSocketsLoopback(PIPE_SIZE);
+			WebSocketsLoopback * serverEnd = new WebSocketsLoopback(PIPE_SIZE);
+			end->link(serverEnd);
+			if(!server.attach(serverEnd)) {
+				delete serverEnd;
+			}
+			return end;
+		}
+};
+
+LoopClient client;
+
+uint8_t payload[4096];
+bool connected = false;
+uint32_t serverFrames = 0;
+uint32_t clientFrames = 0;
+uint32_t badFrames = 0;
+size_t expected = 0;
+
+void serverEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+	if(type == WStype_BIN) {
+		serverFrames++;
+		if(length != expected || memcmp(data, payload, length) != 0) {
+			badFrames++;
+		}
+	}
+}
+
+void clientEvent(WStype_t type, uint8_t * data, size_t length) {
+	switch(type) {
+		case WStype_CONNECTED:
+			connected = true;
+			break;
+		case WStype_DISCONNECTED:
+			connected = false;
+			break;
+		case WStype_BIN:
+			clientFrames++;
+			if(length != expected || memcmp(data, payload, length) != 0) {
+				badFrames++;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+void setup() {
+	USE_SERIAL.begin(115200);
+
+	USE_SERIAL.println();
+	USE_SERIAL.println();
+
+	WiFi.mode(WIFI_OFF);
+
+	for(size_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = random(0xFF);
+	}
+
+	server.onEvent(serverEvent);
+	client.begin("loopback", 81, "/");
+	client.onEvent(clientEvent);
+
+	uint32_t start = ESP.getCycleCount();
+	uint16_t passes = 0;
+	while(!connected && passes < 100) {
+		client.loop();
+		server.run();
+		passes++;
+	}
+	USE_SERIAL.printf("[BENCH] handshake: %s in %u passes, %u cycles\n", connected ? "ok" : "FAILED", passes, ESP.getCycleCount() - start);
+	if(!connected) {
+		return;
+	}
+
+	for(uint8_t s = 0; s < (sizeof(sizes) / sizeof(sizes[0])); s++) {
+		expected = sizes[s];
+
+		WSpoolStats_t serverPool = server.rxPoolStats();
+		WSpoolStats_t clientPool = client.rxPoolStats();
+		uint32_t heapStart = ESP.getFreeHeap();
+
+		// client -> server (masked)
+		uint32_t up = 0;
+		for(uint8_t r = 0; r < BENCH_ROUNDS; r++) {
+			uint32_t frames = serverFrames;
+			start = ESP.getCycleCount();
+			client.sendBIN(payload, expected);
+			for(uint16_t p = 0; serverFrames == frames && p < 1000; p++) {
+				server.run();
+			}
+			up += ESP.getCycleCount() - start;
+		}
+
+		// server -> client
+		uint32_t down = 0;
+		for(uint8_t r = 0; r < BENCH_ROUNDS; r++) {
+			uint32_t frames = clientFrames;
+			start = ESP.getCycleCount();
+			server.sendBIN(0, payload, expected);
+			for(uint16_t p = 0; clientFrames == frames && p < 1000; p++) {
+				client.loop();
+			}
+			down += ESP.getCycleCount() - start;
+		}
+
+		USE_SERIAL.printf("[BENCH] %4u byte: client->server %7u server->client %7u cycles/frame, rx heap allocs %u / %u, heap delta %d\n",
+				expected, up / BENCH_ROUNDS, down / BENCH_ROUNDS,
+				server.rxPoolStats().misses - serverPool.misses, client.rxPoolStats().misses - clientPool.misses,
+				(int) (ESP.getFreeHeap() - heapStart));
+		delay(0);
+	}
+
+	USE_SERIAL.printf("[BENCH] frames: %u / %u (bad: %u)\n", serverFrames, clientFrames, badFrames);
+}
+
+void loop() {
+}
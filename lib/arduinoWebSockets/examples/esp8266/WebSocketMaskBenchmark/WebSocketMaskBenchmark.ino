@@ -0,0 +1,75 @@
+/*
+ * WebSocketMaskBenchmark.ino
+ *
+ * compares the byte wise XOR masking loop with WebSockets::maskPayload
+ * for some typical payload sizes and prints the results in CPU cycles
+ *
+ */
+
+#include <Arduino.h>
+
+#include <WebSockets.h>
+
+#define USE_SERIAL Serial
+
+#define BENCH_ROUNDS 100
+
+static const size_t sizes[] = { 16, 64, 128, 512, 1400, 4096 };
+
+uint8_t buffer[4096 + 4];
+uint8_t maskKey[4] = { 0x37, 0xFA, 0x21, 0x3D };
+
+void maskBytewise(uint8_t * data, size_t length, const uint8_t * key) {
+	for(size_t x = 0; x < length; x++) {
+		data[x] = (data[x] ^ key[x % 4]);
+	}
+}
+
+void bench(size_t length, size_t align) {
+	uint8_t * data = &buffer[align];
+	uint32_t start;
+	uint32_t bytewise;
+	uint32_t wordwise;
+
+	start = ESP.getCycleCount();
+	for(uint8_t r = 0; r < BENCH_ROUNDS; r++) {
+		maskBytewise(data, length, maskKey);
+	}
+	bytewise = (ESP.getCycleCount() - start) / BENCH_ROUNDS;
+
+	start = ESP.getCycleCount();
+	for(uint8_t r = 0; r < BENCH_ROUNDS; r++) {
+		WebSockets::maskPayload(data, length, maskKey);
+	}
+	wordwise = (ESP.getCycleCount() - start) / BENCH_ROUNDS;
+
+	USE_SERIAL.printf("[BENCH] len: %5u align: %u bytewise: %7u cycles maskPayload: %7u cycles (x%u.%02u)\n",
+			length, align, bytewise, wordwise, bytewise / wordwise, ((bytewise * 100) / wordwise) % 100);
+}
+
+void setup() {
+	USE_SERIAL.begin(115200);
+
+	USE_SERIAL.println();
+	USE_SERIAL.println();
+
+	for(size_t i = 0; i < sizeof(buffer); i++) {
+		buffer[i] = random(0xFF);
+	}
+
+	// check both implementations agree before timing them
+	uint8_t check[67];
+	memcpy(check, &buffer[1], sizeof(check));
+	maskBytewise(check, sizeof(check), maskKey);
+	WebSockets::maskPayload(&buffer[1], sizeof(check), maskKey);
+	USE_SERIAL.printf("[BENCH] self check: %s\n", memcmp(check, &buffer[1], sizeof(check)) ? "FAIL" : "ok");
+
+	for(uint8_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+		bench(sizes[i], 0);
+		bench(sizes[i], 1);
+		delay(0);
+	}
+}
+
+void loop() {
+}
@@ -0,0 +1,239 @@
+/*
+ * WebSocketServerLoadTest.ino
+ *
+ * simulates NODE_COUNT nodes on one WebSocketsServer and prints
+ * handshake time, heap per client and the CPU cycles of one loop pass
+ * with all nodes active and with only a few active in the same table
+ *
+ * the nodes are fed from memory, no network is used
+ *
+ */
+
+#include <Arduino.h>
+
+#include <ESP8266WiFi.h>
+#include <WebSocketsServer.h>
+
+#define USE_SERIAL Serial
+
+#define NODE_COUNT 64
+#define FEW_COUNT 4
+#define ROUNDS 20
+#define FRAME_LENGTH 20
+
+static const char request[] = "GET /ws HTTP/1.1\r\n"
+		"Host: 192.168.4.1\r\n"
+		"Connection: Upgrade\r\n"
+		"Upgrade: websocket\r\n"
+		"Sec-WebSocket-Version: 13\r\n"
+		"Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+		"\r\n";
+
+// one node, reads from memory and counts what the server sends
+class SimNode : public WebSocketsTransport {
+	public:
+		int connect(const char * host, uint16_t port) {
+			return 0;
+		}
+		uint8_t connected() {
+			return open;
+		}
+		int available() {
+			return (rxLength - rxPos);
+		}
+		int read() {
+			return (rxPos < rxLength) ? rx[rxPos++] : -1;
+		}
+		int read(uint8_t * buf, size_t size) {
+			if(size > (size_t) available()) {
+				size = available();
+			}
+			memcpy(buf, &rx[rxPos], size);
+			rxPos += size;
+			return size;
+		}
+		int peek() {
+			return (rxPos < rxLength) ? rx[rxPos] : -1;
+		}
+		size_t write(const uint8_t * buf, size_t size) {
+			txBytes += size;
+			return size;
+		}
+		int availableForWrite() {
+			return 1460;
+		}
+		void stop() {
+			open = false;
+		}
+
+		void push(const uint8_t * data, size_t length) {
+			if(rxPos == rxLength) {
+				rxPos = rxLength = 0;
+			}
+			if(length > (sizeof(rx) - rxLength)) {
+				length = (sizeof(rx) - rxLength);
+			}
+			memcpy(&rx[rxLength], data, length);
+			rxLength += length;
+		}
+
+		// masked binary frame, like the MPU data of a node
+		void sendFrame(const uint8_t * payload, uint8_t length) {
+			uint8_t frame[6 + FRAME_LENGTH];
+			uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+			frame[0] = 0x82;
+			frame[1] = 0x80 | length;
+			memcpy(&frame[2], mask, 4);
+			for(uint8_t i = 0; i < length; i++) {
+				frame[6 + i] = payload[i] ^ mask[i % 4];
+			}
+			push(frame, 6 + length);
+		}
+
+		uint8_t rx[192];
+		size_t rxLength = 0;
+		size_t rxPos = 0;
+		size_t txBytes = 0;
+		bool open = true;
+};
+
+class LoadServer : public WebSocketsServer {
+	public:
+		LoadServer() : WebSocketsServer(81, "", "arduino", NODE_COUNT) {
+		}
+
+		bool attach(SimNode * node) {
+			return newClient(node);
+		}
+
+		// loop() without accepting
+		void run() {
+			clientsRelease();
+			handleClientData();
+		}
+};
+
+LoadServer server;
+SimNode * nodes[NODE_COUNT];
+uint8_t payload[FRAME_LENGTH];
+
+uint16_t connects = 0;
+uint16_t disconnects = 0;
+uint32_t frames = 0;
+uint32_t badFrames = 0;
+
+void webSocketEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+	switch(type) {
+		case WStype_CONNECTED:
+			connects++;
+			break;
+		case WStype_DISCONNECTED:
+			disconnects++;
+			break;
+		case WStype_BIN:
+			frames++;
+			if(length != FRAME_LENGTH || memcmp(data, payload, FRAME_LENGTH) != 0) {
+				badFrames++;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+// one loop pass, every node in [0, count) sends one frame
+uint32_t pass(uint8_t count, bool send) {
+	uint32_t cycles = 0;
+	for(uint8_t r = 0; r < ROUNDS; r++) {
+		if(send) {
+			for(uint8_t i = 0; i < count; i++) {
+				nodes[i]->sendFrame(payload, FRAME_LENGTH);
+			}
+		}
+		uint32_t start = ESP.getCycleCount();
+		server.run();
+		cycles += (ESP.getCycleCount() - start);
+		delay(0);
+	}
+	return (cycles / ROUNDS);
+}
+
+void setup() {
+	USE_SERIAL.begin(115200);
+
+	USE_SERIAL.println();
+	USE_SERIAL.println();
+
+	WiFi.mode(WIFI_OFF);
+
+	server.onEvent(webSocketEvent);
+
+	for(uint8_t i = 0; i < FRAME_LENGTH; i++) {
+		payload[i] = random(0xFF);
+	}
+
+	uint32_t heapStart = ESP.getFreeHeap();
+
+	for(uint8_t i = 0; i < NODE_COUNT; i++) {
+		nodes[i] = new SimNode();
+		nodes[i]->push((const uint8_t *) request, strlen(request));
+	}
+
+	uint32_t heapNodes = ESP.getFreeHeap();
+
+	// handshake
+	uint32_t start = ESP.getCycleCount();
+	uint8_t attached = 0;
+	for(uint8_t i = 0; i < NODE_COUNT; i++) {
+		if(server.attach(nodes[i])) {
+			attached++;
+		}
+	}
+	uint16_t passes = 0;
+	while(connects < attached && passes < 200) {
+		server.run();
+		passes++;
+		delay(0);
+	}
+	uint32_t handshake = ESP.getCycleCount() - start;
+
+	USE_SERIAL.printf("[LOAD] nodes: %u attached: %u connected: %u in %u passes, %u cycles per node\n",
+			NODE_COUNT, attached, connects, passes, handshake / NODE_COUNT);
+	USE_SERIAL.printf("[LOAD] heap per client: %u byte (nodes: %u byte)\n",
+			(heapNodes - ESP.getFreeHeap()) / NODE_COUNT, (heapStart - heapNodes));
+
+	// all active
+	uint32_t idleAll = pass(NODE_COUNT, false);
+	uint32_t busyAll = pass(NODE_COUNT, true);
+
+	// broadcast reaches everyone
+	size_t txBefore = nodes[0]->txBytes;
+	server.broadcastBIN(payload, FRAME_LENGTH);
+	uint8_t reached = 0;
+	for(uint8_t i = 0; i < NODE_COUNT; i++) {
+		if(nodes[i]->txBytes > txBefore) {
+			reached++;
+		}
+	}
+
+	// only a few active in the same table
+	for(uint8_t i = FEW_COUNT; i < NODE_COUNT; i++) {
+		server.disconnect(i);
+	}
+	uint32_t idleFew = pass(FEW_COUNT, false);
+	uint32_t busyFew = pass(FEW_COUNT, true);
+
+	USE_SERIAL.printf("[LOAD] loop pass %2u active: idle %7u busy %7u cycles\n", NODE_COUNT, idleAll, busyAll);
+	USE_SERIAL.printf("[LOAD] loop pass %2u active: idle %7u busy %7u cycles\n", FEW_COUNT, idleFew, busyFew);
+	USE_SERIAL.printf("[LOAD] frames: %u (bad: %u) broadcast reached: %u\n", frames, badFrames, reached);
+
+	// the library deletes the nodes on disconnect
+	server.disconnect();
+	server.run();
+
+	USE_SERIAL.printf("[LOAD] disconnected: %u, heap after release: %d byte of start\n",
+			disconnects, (int) (ESP.getFreeHeap() - heapStart));
+}
+
+void loop() {
+}
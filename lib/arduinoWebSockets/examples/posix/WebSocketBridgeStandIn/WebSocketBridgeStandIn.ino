@@ -0,0 +1,159 @@
+/*
+ * WebSocketBridgeStandIn.ino
+ *
+ * bridge stand-in on a Linux host, build with -DWEBSOCKETS_NETWORK_TYPE=NETWORK_POSIX
+ * (the Arduino API comes from host/, the CMake host build has the target WebSocketBridgeStandIn)
+ *
+ * accepts the nodes on BRIDGE_PORT and echoes every binary frame back to the sender
+ *
+ * with LOCAL_NODES > 0 the same process connects that many clients over localhost,
+ * every client keeps one frame in flight, after BENCH_TIME ms the frame rate and
+ * the round trip times are printed (load test / benchmark of the POSIX backend)
+ *
+ */
+
+#include <Arduino.h>
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define USE_SERIAL Serial
+
+#define BRIDGE_PORT 8181
+#define MAX_NODES 128
+#define LOCAL_NODES 64
+#define FRAME_LENGTH 20
+#define BENCH_TIME 5000
+
+WebSocketsServer bridge = WebSocketsServer(BRIDGE_PORT, "", "arduino", MAX_NODES);
+
+uint32_t bridgeFrames = 0;
+
+void bridgeEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+	switch(type) {
+		case WStype_CONNECTED: {
+			IPAddress ip = bridge.remoteIP(num);
+			USE_SERIAL.printf("[BRIDGE][%u] connected from %d.%d.%d.%d url: %s\n", num, ip[0], ip[1], ip[2], ip[3], payload);
+		}
+			break;
+		case WStype_DISCONNECTED:
+			USE_SERIAL.printf("[BRIDGE][%u] disconnected\n", num);
+			break;
+		case WStype_BIN:
+			bridgeFrames++;
+			bridge.sendBIN(num, payload, length);
+			break;
+		default:
+			break;
+	}
+}
+
+#if (LOCAL_NODES > 0)
+class LocalNode {
+	public:
+		void begin() {
+			client.begin("127.0.0.1", BRIDGE_PORT, "/node");
+			client.setReconnectInterval(100);
+			client.onEvent(std::bind(&LocalNode::event, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+		}
+
+		void send() {
+			uint8_t frame[FRAME_LENGTH];
+			uint32_t now = micros();
+			memset(frame, 0x55, sizeof(frame));
+			memcpy(frame, &now, sizeof(now));
+			client.sendBIN(frame, sizeof(frame));
+		}
+
+		void event(WStype_t type, uint8_t * payload, size_t length) {
+			switch(type) {
+				case WStype_CONNECTED:
+					connected = true;
+					send();
+					break;
+				case WStype_DISCONNECTED:
+					connected = false;
+					break;
+				case WStype_BIN:
+					if(length == FRAME_LENGTH) {
+						uint32_t sent;
+						memcpy(&sent, payload, sizeof(sent));
+						uint32_t rtt = micros() - sent;
+						rttSum += rtt;
+						if(rtt > rttMax) {
+							rttMax = rtt;
+						}
+						frames++;
+					}
+					send();
+					break;
+				default:
+					break;
+			}
+		}
+
+		WebSocketsClient client;
+		bool connected = false;
+		uint32_t frames = 0;
+		uint64_t rttSum = 0;
+		uint32_t rttMax = 0;
+};
+
+LocalNode nodes[LOCAL_NODES];
+unsigned long benchStart = 0;
+bool benchDone = false;
+
+void benchReport() {
+	uint16_t connected = 0;
+	uint32_t frames = 0;
+	uint64_t rttSum = 0;
+	uint32_t rttMax = 0;
+	for(uint16_t i = 0; i < LOCAL_NODES; i++) {
+		if(nodes[i].connected) {
+			connected++;
+		}
+		frames += nodes[i].frames;
+		rttSum += nodes[i].rttSum;
+		if(nodes[i].rttMax > rttMax) {
+			rttMax = nodes[i].rttMax;
+		}
+	}
+	USE_SERIAL.printf("[BENCH] nodes: %u connected: %u\n", LOCAL_NODES, connected);
+	USE_SERIAL.printf("[BENCH] frames: %u in %u ms = %u frames/s (bridge saw %u)\n",
+			frames, BENCH_TIME, (uint32_t) ((uint64_t) frames * 1000 / BENCH_TIME), bridgeFrames);
+	USE_SERIAL.printf("[BENCH] rtt avg: %u us max: %u us\n", frames ? (uint32_t) (rttSum / frames) : 0, rttMax);
+}
+#endif
+
+void setup() {
+	USE_SERIAL.begin(115200);
+
+	bridge.begin();
+	bridge.onEvent(bridgeEvent);
+
+	USE_SERIAL.printf("[BRIDGE] listening on %u\n", BRIDGE_PORT);
+
+#if (LOCAL_NODES > 0)
+	for(uint16_t i = 0; i < LOCAL_NODES; i++) {
+		nodes[i].begin();
+	}
+	benchStart = millis();
+#endif
+}
+
+void loop() {
+	bridge.loop();
+
+#if (LOCAL_NODES > 0)
+	if(benchDone) {
+		return;
+	}
+	for(uint16_t i = 0; i < LOCAL_NODES; i++) {
+		nodes[i].client.loop();
+	}
+	if((millis() - benchStart) > BENCH_TIME) {
+		benchReport();
+		benchDone = true;
+	}
+#endif
+}
@@ -0,0 +1,71 @@
+/**
+ * @file Arduino.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "Arduino.h"
+
+#include <time.h>
+#include <unistd.h>
+
+Print Serial;
+
+static unsigned long offset = 0;
+
+static uint64_t monotonicMicros(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static uint64_t start = monotonicMicros();
+
+unsigned long micros(void) {
+    return (unsigned long) (monotonicMicros() - start) + offset * 1000;
+}
+
+unsigned long millis(void) {
+    return (unsigned long) ((monotonicMicros() - start) / 1000) + offset;
+}
+
+void delay(unsigned long ms) {
+    usleep(ms * 1000);
+}
+
+void yield(void) {
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + rand() % (max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    srand(seed);
+}
+
+void hostAdvanceMillis(unsigned long ms) {
+    offset += ms;
+}
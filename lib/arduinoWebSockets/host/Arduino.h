@@ -0,0 +1,323 @@
+/**
+ * @file Arduino.h
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+// minimal Arduino API for the Linux host build (NETWORK_POSIX, host tests)
+// only what the library and the host examples use
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include <string>
+#include <functional>
+
+typedef uint8_t byte;
+
+#define F(str) (str)
+#define PROGMEM
+
+#define bit(b) (1UL << (b))
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void yield(void);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+/**
+ * move millis() / micros() forward without sleeping (tests of timeouts)
+ * @param ms unsigned long
+ */
+void hostAdvanceMillis(unsigned long ms);
+
+class String {
+    public:
+        String(void) {
+        }
+        String(const char * str) :
+                _s(str ? str : "") {
+        }
+        String(const char * str, size_t length) :
+                _s(str, length) {
+        }
+        explicit String(char c) :
+                _s(1, c) {
+        }
+        explicit String(int value) :
+                _s(std::to_string(value)) {
+        }
+        explicit String(unsigned int value) :
+                _s(std::to_string(value)) {
+        }
+        explicit String(long value) :
+                _s(std::to_string(value)) {
+        }
+        explicit String(unsigned long value) :
+                _s(std::to_string(value)) {
+        }
+
+        // like the Arduino String: true as long as it has a buffer, which is always
+        explicit operator bool(void) const {
+            return true;
+        }
+
+        unsigned int length(void) const {
+            return _s.length();
+        }
+        const char * c_str(void) const {
+            return _s.c_str();
+        }
+        bool reserve(unsigned int size) {
+            _s.reserve(size);
+            return true;
+        }
+
+        char operator[](unsigned int index) const {
+            return index < _s.length() ? _s[index] : 0;
+        }
+        char & operator[](unsigned int index) {
+            return _s[index];
+        }
+        char charAt(unsigned int index) const {
+            return (*this)[index];
+        }
+
+        String & operator+=(const String & str) {
+            _s += str._s;
+            return *this;
+        }
+        String & operator+=(const char * str) {
+            _s += str;
+            return *this;
+        }
+        String & operator+=(char c) {
+            _s += c;
+            return *this;
+        }
+        String & operator+=(int value) {
+            _s += std::to_string(value);
+            return *this;
+        }
+        String & operator+=(unsigned int value) {
+            _s += std::to_string(value);
+            return *this;
+        }
+        String & operator+=(unsigned long value) {
+            _s += std::to_string(value);
+            return *this;
+        }
+        bool concat(const char * str, unsigned int length) {
+            _s.append(str, length);
+            return true;
+        }
+
+        bool operator==(const String & str) const {
+            return _s == str._s;
+        }
+        bool operator!=(const String & str) const {
+            return _s != str._s;
+        }
+        bool operator==(const char * str) const {
+            return _s == str;
+        }
+        bool operator!=(const char * str) const {
+            return _s != str;
+        }
+        bool equals(const String & str) const {
+            return _s == str._s;
+        }
+        bool equalsIgnoreCase(const String & str) const {
+            return strcasecmp(_s.c_str(), str._s.c_str()) == 0;
+        }
+        bool startsWith(const String & prefix) const {
+            return _s.compare(0, prefix._s.length(), prefix._s) == 0;
+        }
+        bool endsWith(const String & suffix) const {
+            return _s.length() >= suffix._s.length() && _s.compare(_s.length() - suffix._s.length(), suffix._s.length(), suffix._s) == 0;
+        }
+
+        int indexOf(char c, unsigned int from = 0) const {
+            size_t pos = _s.find(c, from);
+            return pos == std::string::npos ? -1 : (int) pos;
+        }
+        int indexOf(const String & str, unsigned int from = 0) const {
+            size_t pos = _s.find(str._s, from);
+            return pos == std::string::npos ? -1 : (int) pos;
+        }
+        String substring(unsigned int from) const {
+            return substring(from, _s.length());
+        }
+        String substring(unsigned int from, unsigned int to) const {
+            if(from > _s.length()) {
+                return String();
+            }
+            String result;
+            result._s = _s.substr(from, to > from ? to - from : 0);
+            return result;
+        }
+
+        void remove(unsigned int index, unsigned int count) {
+            if(index < _s.length()) {
+                _s.erase(index, count);
+            }
+        }
+        void trim(void) {
+            size_t end = _s.length();
+            while(end > 0 && isspace((unsigned char) _s[end - 1])) {
+                end--;
+            }
+            size_t start = 0;
+            while(start < end && isspace((unsigned char) _s[start])) {
+                start++;
+            }
+            _s = _s.substr(start, end - start);
+        }
+        void toLowerCase(void) {
+            for(size_t i = 0; i < _s.length(); i++) {
+                _s[i] = tolower((unsigned char) _s[i]);
+            }
+        }
+        void toUpperCase(void) {
+            for(size_t i = 0; i < _s.length(); i++) {
+                _s[i] = toupper((unsigned char) _s[i]);
+            }
+        }
+        long toInt(void) const {
+            return atol(_s.c_str());
+        }
+
+    protected:
+        std::string _s;
+};
+
+inline String operator+(const String & a, const String & b) {
+    String result(a);
+    result += b;
+    return result;
+}
+inline String operator+(const String & a, const char * b) {
+    String result(a);
+    result += b;
+    return result;
+}
+inline String operator+(const char * a, const String & b) {
+    String result(a);
+    result += b;
+    return result;
+}
+inline String operator+(const String & a, char b) {
+    String result(a);
+    result += b;
+    return result;
+}
+inline String operator+(const String & a, int b) {
+    String result(a);
+    result += b;
+    return result;
+}
+inline String operator+(const String & a, unsigned int b) {
+    String result(a);
+    result += b;
+    return result;
+}
+inline String operator+(const String & a, unsigned long b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+/**
+ * console output (stdout)
+ */
+class Print {
+    public:
+        virtual ~Print(void) {
+        }
+
+        // line buffered, output shows up like on a serial console
+        void begin(unsigned long baud) {
+            setvbuf(stdout, NULL, _IOLBF, 0);
+        }
+        void setDebugOutput(bool enable) {
+        }
+        void flush(void) {
+            fflush(stdout);
+        }
+
+        size_t print(const char * str) {
+            return fputs(str, stdout) >= 0 ? strlen(str) : 0;
+        }
+        size_t print(const String & str) {
+            return print(str.c_str());
+        }
+        size_t print(char c) {
+            return fputc(c, stdout) != EOF;
+        }
+        size_t print(long value) {
+            return printf("%ld", value);
+        }
+        size_t print(unsigned long value) {
+            return printf("%lu", value);
+        }
+        size_t print(int value) {
+            return print((long) value);
+        }
+        size_t print(unsigned int value) {
+            return print((unsigned long) value);
+        }
+
+        size_t println(void) {
+            return print("\n");
+        }
+        template<typename T>
+        size_t println(T value) {
+            size_t n = print(value);
+            return n + println();
+        }
+
+        size_t printf(const char * format, ...) __attribute__((format(printf, 2, 3))) {
+            va_list args;
+            va_start(args, format);
+            int n = vprintf(format, args);
+            va_end(args);
+            return n > 0 ? n : 0;
+        }
+};
+
+extern Print Serial;
+
+#include "IPAddress.h"
+
+#endif /* HOST_ARDUINO_H_ */
@@ -0,0 +1,77 @@
+/**
+ * @file IPAddress.h
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_IPADDRESS_H_
+#define HOST_IPADDRESS_H_
+
+#include "Arduino.h"
+
+/**
+ * IPv4 address, octets in network order like on the Arduino cores
+ */
+class IPAddress {
+    public:
+        IPAddress(void) {
+            memset(_address, 0, sizeof(_address));
+        }
+        IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+            _address[0] = a;
+            _address[1] = b;
+            _address[2] = c;
+            _address[3] = d;
+        }
+        IPAddress(uint32_t address) {
+            memcpy(_address, &address, sizeof(_address));
+        }
+
+        operator uint32_t(void) const {
+            uint32_t address;
+            memcpy(&address, _address, sizeof(address));
+            return address;
+        }
+        bool operator==(const IPAddress & other) const {
+            return memcmp(_address, other._address, sizeof(_address)) == 0;
+        }
+        bool operator!=(const IPAddress & other) const {
+            return !(*this == other);
+        }
+
+        uint8_t operator[](int index) const {
+            return _address[index];
+        }
+        uint8_t & operator[](int index) {
+            return _address[index];
+        }
+
+        String toString(void) const {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address[0], _address[1], _address[2], _address[3]);
+            return String(buf);
+        }
+
+    protected:
+        uint8_t _address[4];
+};
+
+#endif /* HOST_IPADDRESS_H_ */
@@ -0,0 +1,27 @@
+/**
+ * @file WebSocketBridgeStandIn.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// host build of the examples/posix sketch
+
+#include "../examples/posix/WebSocketBridgeStandIn/WebSocketBridgeStandIn.ino"
@@ -48,6 +48,30 @@ extern "C" {
 
 #endif
 
+WebSockets::WebSockets() {
+    memset(&_rxPoolUsed[0], 0x00, sizeof(_rxPoolUsed));
+    memset(&_rxPoolStats, 0x00, sizeof(_rxPoolStats));
+
+    _txQueueDepth = WEBSOCKETS_TX_QUEUE_DEPTH;
+    _txQueueMaxAge = 0;
+    _txQueuePolicy = WSqueue_block;
+    _txQueueOnDemand = false;
+}
+
+/**
+ * configure the send queue
+ * @param depth uint8_t             max frames waiting (max WEBSOCKETS_TX_QUEUE_DEPTH)
+ * @param maxAge unsigned long      drop frames waiting longer then maxAge ms (0 = never)
+ * @param policy WSqueuePolicy_t    what to do when a frame does not fit
+ */
+void WebSockets::setSendQueue(uint8_t depth, unsigned long maxAge, WSqueuePolicy_t policy) {
+    if(depth == 0 || depth > WEBSOCKETS_TX_QUEUE_DEPTH) {
+        depth = WEBSOCKETS_TX_QUEUE_DEPTH;
+    }
+    _txQueueDepth = depth;
+    _txQueueMaxAge = maxAge;
+    _txQueuePolicy = policy;
+}
 
 /**
  *
@@ -67,6 +91,8 @@ void WebSockets::clientDisconnect(WSclient_t * client, uint16_t code, char * rea
             buffer[1] = (code & 0xFF);
             sendFrame(client, WSop_close, &buffer[0], 2);
         }
+        // the close frame has to be on the wire before the connection is closed
+        txFlush(client, true);
     }
     clientDisconnect(client);
 }
@@ -104,37 +130,21 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
     uint8_t maskKey[4] = { 0x00, 0x00, 0x00, 0x00 };
     uint8_t buffer[WEBSOCKETS_MAX_HEADER_SIZE] = { 0 };
 
-    uint8_t headerSize;
+    uint8_t headerSize = frameHeaderSize(length, mask);
     uint8_t * headerPtr;
     uint8_t * payloadPtr = payload;
     bool useInternBuffer = false;
     bool ret = true;
 
-    // calculate header Size
-    if(length < 126) {
-        headerSize = 2;
-    } else if(length < 0xFFFF) {
-        headerSize = 4;
-    } else {
-        headerSize = 10;
-    }
-
-    if(mask) {
-        headerSize += 4;
-    }
-
 #ifdef WEBSOCKETS_USE_BIG_MEM
     // only for ESP since AVR has less HEAP
-    // try to send data in one TCP package (only if some free Heap is there)
-    if(!headerToPayload && ((length > 0) && (length < 1400)) && (GET_FREE_HEAP > 6000)) {
+    // build the frame in the transmit arena of the client to send it in one TCP package
+    if(!headerToPayload && ((length > 0) && (length <= WEBSOCKETS_TX_ARENA_PAYLOAD)) && client->txArena) {
         DEBUG_WEBSOCKETS("[WS][%d][sendFrame] pack to one TCP package...\n", client->num);
-        uint8_t * dataPtr = (uint8_t *) malloc(length + WEBSOCKETS_MAX_HEADER_SIZE);
-        if(dataPtr) {
-            memcpy((dataPtr + WEBSOCKETS_MAX_HEADER_SIZE), payload, length);
-            headerToPayload = true;
-            useInternBuffer = true;
-            payloadPtr = dataPtr;
-        }
+        memcpy((client->txArena + WEBSOCKETS_MAX_HEADER_SIZE), payload, length);
+        headerToPayload = true;
+        useInternBuffer = true;
+        payloadPtr = client->txArena;
     }
 #endif
 
@@ -146,7 +156,195 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
         headerPtr = &buffer[0];
     }
 
+    if(mask && useInternBuffer) {
+        // if we use a Intern Buffer we can modify the data
+        // by this fact its possible the do the masking
+        for(uint8_t x = 0; x < sizeof(maskKey); x++) {
+            maskKey[x] = random(0xFF);
+        }
+    }
+
     // create header
+    createHeader(headerPtr, opcode, length, mask, maskKey, fin);
+
+    if(mask && useInternBuffer) {
+        maskPayload((payloadPtr + WEBSOCKETS_MAX_HEADER_SIZE), length, maskKey);
+    }
+
+#ifndef NODEBUG_WEBSOCKETS
+    unsigned long start = micros();
+#endif
+
+    if(headerToPayload) {
+        // header has be added to payload
+        // payload is forced to reserved 14 Byte but we may not need all based on the length and mask settings
+        // offset in payload is calculatetd 14 - headerSize
+        if(write(client, &payloadPtr[(WEBSOCKETS_MAX_HEADER_SIZE - headerSize)], (length + headerSize)) != (length + headerSize)) {
+            ret = false;
+        }
+    } else {
+        // send header and payload (queued as one frame)
+        if(!payloadPtr) {
+            length = 0;
+        }
+        if(write(client, &buffer[0], headerSize, payloadPtr, length) != (headerSize + length)) {
+            ret = false;
+        }
+    }
+
+    DEBUG_WEBSOCKETS("[WS][%d][sendFrame] sending Frame Done (%luus).\n", client->num, (micros() - start));
+
+    return ret;
+}
+
+/**
+ * send a message as fragments (first frame opcode, then WSop_continuation) chunk by chunk
+ * only one chunk is in RAM, the transmit arena if the chunk fits and the arena is not shared, else one heap buffer
+ * the producer must not send on the same connection
+ * a message that is not completely on the wire (or queued and flushed within WEBSOCKETS_TCP_TIMEOUT) closes the connection (1011)
+ * @param client WSclient_t *   ptr to the client struct
+ * @param opcode WSopcode_t     WSop_text or WSop_binary
+ * @param producer WSstreamProducer  fills the next chunk, a short chunk ends the message
+ * @param chunkSize size_t      max payload per frame
+ * @param mask bool             key is random for every frame
+ * @param arena bool            false: the arena is shared with other connections (server), a send of the producer would overwrite the chunk
+ * @return true if ok
+ */
+bool WebSockets::sendStream(WSclient_t * client, WSopcode_t opcode, WSstreamProducer producer, size_t chunkSize, bool mask, bool arena) {
+
+    if(client->tcp && !client->tcp->connected()) {
+        DEBUG_WEBSOCKETS("[WS][%d][sendStream] not Connected!?\n", client->num);
+        return false;
+    }
+
+    if(client->status != WSC_CONNECTED) {
+        DEBUG_WEBSOCKETS("[WS][%d][sendStream] not in WSC_CONNECTED state!?\n", client->num);
+        return false;
+    }
+
+    if(!producer || chunkSize == 0) {
+        return false;
+    }
+
+    uint8_t * buffer = NULL;
+#ifdef WEBSOCKETS_USE_BIG_MEM
+    if(arena && chunkSize <= WEBSOCKETS_TX_ARENA_PAYLOAD) {
+        buffer = client->txArena;
+    }
+#endif
+    bool allocated = false;
+    if(!buffer) {
+        buffer = (uint8_t *) malloc(WEBSOCKETS_MAX_HEADER_SIZE + chunkSize);
+        if(!buffer) {
+            DEBUG_WEBSOCKETS("[WS][%d][sendStream] to less memory for %u byte chunks!\n", client->num, chunkSize);
+            return false;
+        }
+        allocated = true;
+    }
+
+    // a dropped or expired fragment would break the message, wait for space instead
+    WSqueuePolicy_t policy = _txQueuePolicy;
+    unsigned long maxAge = _txQueueMaxAge;
+    _txQueuePolicy = WSqueue_block;
+    _txQueueMaxAge = 0;
+
+    uint8_t * payload = (buffer + WEBSOCKETS_MAX_HEADER_SIZE);
+    uint8_t maskKey[4] = { 0x00, 0x00, 0x00, 0x00 };
+    size_t total = 0;
+    uint32_t frames = 0;
+    bool fin = false;
+    bool ret = true;
+
+    while(ret && !fin) {
+        size_t length = producer(payload, chunkSize);
+        if(length > chunkSize) {
+            length = chunkSize;
+        }
+        fin = (length < chunkSize);
+
+        uint8_t headerSize = frameHeaderSize(length, mask);
+        uint8_t * headerPtr = (buffer + (WEBSOCKETS_MAX_HEADER_SIZE - headerSize));
+
+        if(mask) {
+            for(uint8_t x = 0; x < sizeof(maskKey); x++) {
+                maskKey[x] = random(0xFF);
+            }
+        }
+
+        createHeader(headerPtr, opcode, length, mask, maskKey, fin);
+
+        if(mask) {
+            maskPayload(payload, length, maskKey);
+        }
+
+        if(write(client, headerPtr, (length + headerSize)) != (length + headerSize)) {
+            ret = false;
+            break;
+        }
+
+        total += length;
+        frames++;
+        opcode = WSop_continuation;
+    }
+
+    if(allocated) {
+        free(buffer);
+    }
+
+    // the queued fragments must not expire later, a message not on the wire after the timeout is broken
+    if(ret) {
+        txFlush(client, true);
+        if(client->txQueue && client->txQueue->count) {
+            DEBUG_WEBSOCKETS("[WS][%d][sendStream] %u frames not on the wire!\n", client->num, client->txQueue->count);
+            ret = false;
+        }
+    }
+    _txQueuePolicy = policy;
+    _txQueueMaxAge = maxAge;
+
+    DEBUG_WEBSOCKETS("[WS][%d][sendStream] %u byte in %u frames, ok: %d\n", client->num, total, frames, ret);
+
+    if(!ret && client->status == WSC_CONNECTED) {
+        // the message is incomplete (or a frame partly written), the other side can not resync
+        clientDisconnect(client, 1011);
+    }
+    return ret;
+}
+
+/**
+ * size of a frame header
+ * @param length size_t  payload length
+ * @param mask bool
+ * @return header size in byte
+ */
+uint8_t WebSockets::frameHeaderSize(size_t length, bool mask) {
+    uint8_t headerSize;
+    if(length < 126) {
+        headerSize = 2;
+    } else if(length < 0xFFFF) {
+        headerSize = 4;
+    } else {
+        headerSize = 10;
+    }
+
+    if(mask) {
+        headerSize += 4;
+    }
+    return headerSize;
+}
+
+/**
+ * write a frame header
+ * @param headerPtr uint8_t *  out, frameHeaderSize(length, mask) byte
+ * @param opcode WSopcode_t
+ * @param length size_t  payload length
+ * @param mask bool
+ * @param maskKey const uint8_t *  4 byte, only used if mask is set
+ * @param fin bool
+ * @return header size in byte
+ */
+uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t length, bool mask, const uint8_t * maskKey, bool fin) {
+    uint8_t * start = headerPtr;
 
     // byte 0
     *headerPtr = 0x00;
@@ -195,73 +393,74 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
     }
 
     if(mask) {
-        if(useInternBuffer) {
-            // if we use a Intern Buffer we can modify the data
-            // by this fact its possible the do the masking
-            for(uint8_t x = 0; x < sizeof(maskKey); x++) {
-                maskKey[x] = random(0xFF);
-                *headerPtr = maskKey[x];
-                headerPtr++;
-            }
-
-            uint8_t * dataMaskPtr;
+        for(uint8_t x = 0; x < 4; x++) {
+            *headerPtr = maskKey[x];
+            headerPtr++;
+        }
+    }
 
-            if(headerToPayload) {
-                dataMaskPtr = (payloadPtr + WEBSOCKETS_MAX_HEADER_SIZE);
-            } else {
-                dataMaskPtr = payloadPtr;
-            }
+    return (headerPtr - start);
+}
 
-            for(size_t x = 0; x < length; x++) {
-                dataMaskPtr[x] = (dataMaskPtr[x] ^ maskKey[x % 4]);
-            }
+/**
+ * XOR mask / unmask data in place (see RFC6455 5.3)
+ * the bulk is done word wise on aligned memory, only the unaligned head and the tail are done byte wise
+ * @param data uint8_t *        ptr to the data
+ * @param length size_t         length of the data
+ * @param maskKey uint8_t *     ptr to the 4 byte mask key
+ * @param offset size_t         position of data[0] inside the frame payload (allows masking in chunks)
+ */
+void WebSockets::maskPayload(uint8_t * data, size_t length, const uint8_t * maskKey, size_t offset) {
+    typedef WEBSOCKETS_MASK_WORD __attribute__((__may_alias__)) maskWord_t;
 
-        } else {
-            *headerPtr = maskKey[0];
-            headerPtr++;
-            *headerPtr = maskKey[1];
-            headerPtr++;
-            *headerPtr = maskKey[2];
-            headerPtr++;
-            *headerPtr = maskKey[3];
-            headerPtr++;
-        }
+    if(!data || !length) {
+        return;
     }
 
-#ifndef NODEBUG_WEBSOCKETS
-    unsigned long start = micros();
-#endif
+    size_t phase = (offset & 0x03);
 
-    if(headerToPayload) {
-        // header has be added to payload
-        // payload is forced to reserved 14 Byte but we may not need all based on the length and mask settings
-        // offset in payload is calculatetd 14 - headerSize
-        if(write(client, &payloadPtr[(WEBSOCKETS_MAX_HEADER_SIZE - headerSize)], (length + headerSize)) != (length + headerSize)) {
-            ret = false;
+    // unaligned head
+    while(length && ((uintptr_t) data & (sizeof(maskWord_t) - 1))) {
+        *data++ ^= maskKey[phase];
+        phase = ((phase + 1) & 0x03);
+        length--;
+    }
+
+    if(length >= sizeof(maskWord_t)) {
+        // key rotated to the current phase, repeated to fill one word (memory order)
+        uint8_t keyBytes[sizeof(maskWord_t)];
+        for(uint8_t x = 0; x < sizeof(maskWord_t); x++) {
+            keyBytes[x] = maskKey[(phase + x) & 0x03];
         }
-    } else {
-        // send header
-        if(write(client, &buffer[0], headerSize) != headerSize) {
-            ret = false;
+        maskWord_t key;
+        memcpy(&key, &keyBytes[0], sizeof(key));
+
+        maskWord_t * word = (maskWord_t *) data;
+        size_t words = (length / sizeof(maskWord_t));
+
+        // 4 words per round to keep the pipeline busy
+        while(words >= 4) {
+            word[0] ^= key;
+            word[1] ^= key;
+            word[2] ^= key;
+            word[3] ^= key;
+            word += 4;
+            words -= 4;
         }
-
-        if(payloadPtr && length > 0) {
-            // send payload
-            if(write(client, &payloadPtr[0], length) != length) {
-                ret = false;
-            }
+        while(words--) {
+            *word++ ^= key;
         }
-    }
-
-    DEBUG_WEBSOCKETS("[WS][%d][sendFrame] sending Frame Done (%luus).\n", client->num, (micros() - start));
 
-#ifdef WEBSOCKETS_USE_BIG_MEM
-    if(useInternBuffer && payloadPtr) {
-        free(payloadPtr);
+        data = (uint8_t *) word;
+        // word size is a multiple of 4 so the phase is unchanged
+        length &= (sizeof(maskWord_t) - 1);
     }
-#endif
 
-    return ret;
+    // tail
+    while(length--) {
+        *data++ ^= maskKey[phase];
+        phase = ((phase + 1) & 0x03);
+    }
 }
 
 /**
@@ -270,24 +469,144 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
  */
 void WebSockets::headerDone(WSclient_t * client) {
     client->status = WSC_CONNECTED;
-    client->cWsRXsize = 0;
+    handleWebsocketReset(client);
     DEBUG_WEBSOCKETS("[WS][%d][headerDone] Header Handling Done.\n", client->num);
+    if(client->header) {
+        client->header->cHttpLine = "";
+    }
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-    client->cHttpLine = "";
     handleWebsocket(client);
 #endif
 }
 
 /**
  * handle the WebSocket stream
+ * sync network types: consumes what the TCP stack has, a frame may be spread over many calls
  * @param client WSclient_t *  ptr to the client struct
+ * @param maxBytes size_t  stop after x byte (0 = no limit), the rest is read on the next call
+ * @param maxTime unsigned long  stop when x us are used up, checked after each read (0 = no limit)
  */
-void WebSockets::handleWebsocket(WSclient_t * client) {
+void WebSockets::handleWebsocket(WSclient_t * client, size_t maxBytes, unsigned long maxTime) {
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    UNUSED(maxBytes);
+    UNUSED(maxTime);
     if(client->cWsRXsize == 0) {
         handleWebsocketCb(client);
     }
+#else
+    int available;
+    unsigned long start = micros();
+
+    while(client->tcp && client->status == WSC_CONNECTED && (available = client->tcp->available()) > 0) {
+        int len;
+
+        if(maxBytes) {
+            if((size_t) available > maxBytes) {
+                available = maxBytes;
+            }
+        }
+
+        if(!client->cWsPayload) {
+            // header
+            uint8_t size = headerSize(client);
+            if(size > WEBSOCKETS_MAX_HEADER_SIZE) {
+                clientDisconnect(client, 1002);
+                return;
+            }
+
+            uint8_t need = (size - client->cWsRXsize);
+            len = client->tcp->read(&client->cWsHeader[client->cWsRXsize], ((size_t) available < need) ? available : need);
+            if(len <= 0) {
+                break;
+            }
+            client->cWsRXsize += len;
+            client->cWsRXtime = millis();
+
+            // the size is only known when the first 2 byte are there
+            if(client->cWsRXsize == headerSize(client)) {
+                handleWebsocketCb(client);
+            }
+        } else {
+            // payload
+            WSMessageHeader_t * header = &client->cWsHeaderDecode;
+            size_t need = (header->payloadLen - client->cWsPayloadRX);
+            len = client->tcp->read(&client->cWsPayload[client->cWsPayloadRX], ((size_t) available < need) ? available : need);
+            if(len <= 0) {
+                break;
+            }
+            client->cWsPayloadRX += len;
+            client->cWsRXtime = millis();
+
+            if(client->cWsPayloadRX == header->payloadLen) {
+                uint8_t * payload = client->cWsPayload;
+                client->cWsPayload = NULL;
+                handleWebsocketPayloadCb(client, true, payload);
+            }
+        }
+
+        if(maxBytes) {
+            if((size_t) len >= maxBytes) {
+                break;
+            }
+            maxBytes -= len;
+        }
+
+        if(maxTime && (micros() - start) >= maxTime) {
+            break;
+        }
+    }
+
+    // a frame stuck half way
+    if(client->tcp && (client->cWsRXsize || client->cWsPayload) && (millis() - client->cWsRXtime) > WEBSOCKETS_TCP_TIMEOUT) {
+        DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] receive TIMEOUT! %lu\n", client->num, (millis() - client->cWsRXtime));
+        clientDisconnect(client, 1002);
+    }
+#endif
+}
+
+/**
+ * drop a half received frame (connection is gone)
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::handleWebsocketReset(WSclient_t * client) {
+    if(client->cWsPayload) {
+        rxFree(client->cWsPayload);
+        client->cWsPayload = NULL;
+    }
+    client->cWsPayloadRX = 0;
+    client->cWsRXsize = 0;
 }
 
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * size of the frame header based on the bytes received so far
+ * @param client WSclient_t *  ptr to the client struct
+ * @return uint8_t header size (2 until the first 2 byte are received)
+ */
+uint8_t WebSockets::headerSize(WSclient_t * client) {
+    uint8_t size = 2;
+
+    if(client->cWsRXsize < 2) {
+        return size;
+    }
+
+    switch(client->cWsHeader[1] & 0x7F) {
+        case 126:
+            size += 2;
+            break;
+        case 127:
+            size += 8;
+            break;
+    }
+
+    if(client->cWsHeader[1] & bit(7)) {
+        size += 4;
+    }
+
+    return size;
+}
+#endif
+
 /**
  * wait for
  * @param client
@@ -307,6 +626,10 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
         return true;
     }
 
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    // handleWebsocket collects the complete header before the decode starts
+    return false;
+#else
     DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor] size: %d cWsRXsize: %d\n", client->num, size, client->cWsRXsize);
     readCb(client, &client->cWsHeader[client->cWsRXsize], (size - client->cWsRXsize), std::bind([](WebSockets * server, size_t size, WSclient_t * client, bool ok) {
         DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor][readCb] size: %d ok: %d\n", client->num, size, ok);
@@ -321,6 +644,7 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
         }
     }, this, size, std::placeholders::_1, std::placeholders::_2));
     return false;
+#endif
 }
 
 void WebSockets::handleWebsocketCb(WSclient_t * client) {
@@ -396,14 +720,20 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
 
     if(header->payloadLen > 0) {
         // if text data we need one more
-        payload = (uint8_t *) malloc(header->payloadLen + 1);
+        payload = rxAlloc(header->payloadLen + 1);
 
         if(!payload) {
             DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] to less memory to handle payload %d!\n", client->num, header->payloadLen);
             clientDisconnect(client, 1011);
             return;
         }
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
         readCb(client, payload, header->payloadLen, std::bind(&WebSockets::handleWebsocketPayloadCb, this, std::placeholders::_1, std::placeholders::_2, payload));
+#else
+        // filled by handleWebsocket
+        client->cWsPayload = payload;
+        client->cWsPayloadRX = 0;
+#endif
     } else {
         handleWebsocketPayloadCb(client, true, NULL);
     }
@@ -418,9 +748,7 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
 
             if(header->mask) {
                 //decode XOR
-                for(size_t i = 0; i < header->payloadLen; i++) {
-                    payload[i] = (payload[i] ^ header->maskKey[i % 4]);
-                }
+                maskPayload(payload, header->payloadLen, header->maskKey);
             }
         }
 
@@ -435,9 +763,11 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
             case WSop_ping:
                 // send pong back
                 sendFrame(client, WSop_pong, payload, header->payloadLen, true);
+                messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
                 break;
             case WSop_pong:
-                DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] get pong (%s)\n", client->num, payload ? (const char*)payload : "");
+                DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] get pong (%u byte)\n", client->num, header->payloadLen);
+                messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
                 break;
             case WSop_close: {
                 #ifndef NODEBUG_WEBSOCKETS
@@ -461,7 +791,7 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
         }
 
         if(payload) {
-            free(payload);
+            rxFree(payload);
         }
 
         // reset input
@@ -473,11 +803,83 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
 
     } else {
         DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] missing data!\n", client->num);
-        free(payload);
+        rxFree(payload);
         clientDisconnect(client, 1002);
     }
 }
 
+/**
+ * reserve the transmit arena of a client
+ * called on connect, the arena is kept for the lifetime of the client slot
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::txArenaReserve(WSclient_t * client) {
+#ifdef WEBSOCKETS_USE_BIG_MEM
+    if(!client->txArena) {
+        client->txArena = (uint8_t *) malloc(WEBSOCKETS_MAX_HEADER_SIZE + WEBSOCKETS_TX_ARENA_PAYLOAD);
+        if(!client->txArena) {
+            DEBUG_WEBSOCKETS("[WS][%d][txArenaReserve] to less memory, frames are send in two parts!\n", client->num);
+        }
+    }
+#else
+    UNUSED(client);
+#endif
+}
+
+/**
+ * release the transmit arena of a client
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::txArenaRelease(WSclient_t * client) {
+    if(client->txArena) {
+        free(client->txArena);
+        client->txArena = NULL;
+    }
+}
+
+/**
+ * get a receive buffer, small payloads are served from the pool
+ * so commands and pings do not fragment the heap
+ * @param size size_t   needed size (incl. text terminator)
+ * @return uint8_t * buffer or NULL
+ */
+uint8_t * WebSockets::rxAlloc(size_t size) {
+    if(size <= (WEBSOCKETS_MAX_COMMAND_SIZE + 1)) {
+        for(uint8_t i = 0; i < WEBSOCKETS_RX_POOL_SIZE; i++) {
+            if(!_rxPoolUsed[i]) {
+                _rxPoolUsed[i] = true;
+                _rxPoolStats.hits++;
+                _rxPoolStats.inUse++;
+                return &_rxPool[i][0];
+            }
+        }
+    }
+
+    DEBUG_WEBSOCKETS("[WS][rxAlloc] pool miss (%u)\n", size);
+    _rxPoolStats.misses++;
+    return (uint8_t *) malloc(size);
+}
+
+/**
+ * release a buffer from rxAlloc
+ * @param buffer uint8_t *
+ */
+void WebSockets::rxFree(uint8_t * buffer) {
+    if(!buffer) {
+        return;
+    }
+
+    for(uint8_t i = 0; i < WEBSOCKETS_RX_POOL_SIZE; i++) {
+        if(buffer == &_rxPool[i][0]) {
+            _rxPoolUsed[i] = false;
+            _rxPoolStats.inUse--;
+            return;
+        }
+    }
+
+    free(buffer);
+}
+
 /**
  * generate the key for Sec-WebSocket-Accept
  * @param clientKey String
@@ -504,6 +906,49 @@ String WebSockets::acceptKey(String & clientKey) {
     return key;
 }
 
+/**
+ * generate the key for Sec-WebSocket-Accept without heap use
+ * @param clientKey const char *  Sec-WebSocket-Key (WEBSOCKETS_KEY_LENGTH chars)
+ * @param accept char *  out, WEBSOCKETS_ACCEPT_LENGTH + 1 byte
+ */
+void WebSockets::acceptKey(const char * clientKey, char * accept) {
+    static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t sha1HashBin[20] = { 0 };
+    uint8_t data[WEBSOCKETS_KEY_LENGTH + sizeof(guid) - 1];
+
+    memcpy(&data[0], clientKey, WEBSOCKETS_KEY_LENGTH);
+    memcpy(&data[WEBSOCKETS_KEY_LENGTH], guid, sizeof(guid) - 1);
+
+#ifdef ESP8266
+    sha1(&data[0], sizeof(data), &sha1HashBin[0]);
+#elif defined(ESP32)
+    esp_sha(SHA1, &data[0], sizeof(data), &sha1HashBin[0]);
+#else
+    SHA1_CTX ctx;
+    SHA1Init(&ctx);
+    SHA1Update(&ctx, &data[0], sizeof(data));
+    SHA1Final(&sha1HashBin[0], &ctx);
+#endif
+
+    base64_encode(sha1HashBin, sizeof(sha1HashBin), accept);
+}
+
+/**
+ * base64_encode into a caller buffer (no line breaks for length < 54)
+ * @param data const uint8_t *
+ * @param length size_t
+ * @param out char *  needs ((length + 2) / 3) * 4 + 1 byte
+ * @return encoded length
+ */
+size_t WebSockets::base64_encode(const uint8_t * data, size_t length, char * out) {
+    base64_encodestate _state;
+    base64_init_encodestate(&_state);
+    int len = base64_encode_block((const char *) &data[0], length, &out[0], &_state);
+    len += base64_encode_blockend((out + len), &_state);
+    // blockend counts the terminating 0
+    return len - 1;
+}
+
 /**
  * base64_encode
  * @param data uint8_t *
@@ -526,15 +971,15 @@ String WebSockets::base64_encode(uint8_t * data, size_t length) {
     return String("-FAIL-");
 }
 
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
 /**
- * read x byte from tcp or get timeout
+ * read x byte from tcp, cb is called when done
  * @param client WSclient_t *
  * @param out  uint8_t * data buffer
  * @param n size_t byte count
  * @return true if ok
  */
 bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWaitCb cb) {
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     if(!client->tcp || !client->tcp->connected()) {
         return false;
     }
@@ -545,72 +990,188 @@ bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWait
         }
     }, client, std::placeholders::_1, cb));
 
-#else
-    unsigned long t = millis();
-    size_t len;
-    DEBUG_WEBSOCKETS("[readCb] n: %zu t: %lu\n", n, t);
-    while(n > 0) {
-        if(client->tcp == NULL) {
-            DEBUG_WEBSOCKETS("[readCb] tcp is null!\n");
-            if(cb) {
-                cb(client, false);
-            }
-            return false;
+    return true;
+}
+#endif
+
+/**
+ * wrap a position in the send queue ring buffer
+ * (no modulo, WEBSOCKETS_TX_QUEUE_SIZE can be 0)
+ */
+static inline size_t txQueueWrap(size_t pos) {
+    return (pos >= WEBSOCKETS_TX_QUEUE_SIZE) ? (pos - WEBSOCKETS_TX_QUEUE_SIZE) : pos;
+}
+
+/**
+ * write x byte to tcp
+ * the data is queued when the TCP window is full (see setSendQueue)
+ * @param client WSclient_t *
+ * @param out  uint8_t * data buffer
+ * @param n size_t byte count
+ * @return bytes send or queued
+ */
+size_t WebSockets::write(WSclient_t * client, uint8_t *out, size_t n) {
+	return write(client, out, n, NULL, 0);
+}
+
+size_t WebSockets::write(WSclient_t * client, const char *out) {
+	if(client == NULL) return 0;
+	if(out == NULL) return 0;
+	return write(client, (uint8_t*)out, strlen(out));
+}
+
+/**
+ * write two buffers as one unit (frame header + payload)
+ * both parts are send or queued together, a policy drop removes both
+ * @param client WSclient_t *
+ * @param out  uint8_t * first buffer
+ * @param n size_t first byte count
+ * @param out2  uint8_t * second buffer (can be NULL)
+ * @param n2 size_t second byte count
+ * @return bytes send or queued
+ */
+size_t WebSockets::write(WSclient_t * client, uint8_t * out, size_t n, uint8_t * out2, size_t n2) {
+    if(out == NULL) return 0;
+    if(client == NULL) return 0;
+    if(out2 == NULL) n2 = 0;
+
+    WSqueue_t * queue = client->txQueue;
+    size_t total = n + n2;
+    size_t sent = 0;
+    bool direct = false; ///< already tried to put it on the wire
+
+    if(!queue && _txQueueOnDemand) {
+        // clients that keep up never need a queue
+        sent = writeDirect(client, out, n, false);
+        if(sent == n && n2) {
+            sent += writeDirect(client, out2, n2, false);
         }
+        if(sent == total || !client->tcp || !client->tcp->connected()) {
+            return sent;
+        }
+        txQueueReserve(client);
+        queue = client->txQueue;
+        direct = true;
+    }
 
-        if(!client->tcp->connected()) {
-            DEBUG_WEBSOCKETS("[readCb] not connected!\n");
-            if(cb) {
-                cb(client, false);
-            }
-            return false;
+    if(!queue) {
+        if(sent < n) {
+            sent += writeDirect(client, out + sent, (n - sent), true);
+        }
+        if(sent >= n && n2) {
+            sent += writeDirect(client, out2 + (sent - n), (total - sent), true);
         }
+        return sent;
+    }
 
-        if((millis() - t) > WEBSOCKETS_TCP_TIMEOUT) {
-            DEBUG_WEBSOCKETS("[readCb] receive TIMEOUT! %lu\n", (millis() - t));
-            if(cb) {
-                cb(client, false);
-            }
-            return false;
+    // keep the order, waiting data first
+    txFlush(client);
+
+    if(!direct && queue->count == 0) {
+        // nothing is waiting, put as much as possible on the wire right away
+        sent = writeDirect(client, out, n, false);
+        if(sent == n && n2) {
+            sent += writeDirect(client, out2, n2, false);
+        }
+        if(sent == total) {
+            return total;
+        }
+        if(!client->tcp || !client->tcp->connected()) {
+            return sent;
         }
+    }
 
-        if(!client->tcp->available()) {
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
-            delay(0);
-#endif
-            continue;
+    size_t left = (total - sent);
+
+    if(left > WEBSOCKETS_TX_QUEUE_SIZE || left > 0xFFFF) {
+        // will never fit in to the queue, send it the old way
+        DEBUG_WEBSOCKETS("[WS][%d][write] %u byte to big for queue, blocking\n", client->num, left);
+        queue->stats.blocked++;
+        txFlush(client, true);
+        if(sent < n) {
+            sent += writeDirect(client, out + sent, (n - sent), true);
+        }
+        if(sent >= n && n2) {
+            sent += writeDirect(client, out2 + (sent - n), (total - sent), true);
         }
+        return sent;
+    }
 
-        len = client->tcp->read((uint8_t*) out, n);
-        if(len) {
-            t = millis();
-            out += len;
-            n -= len;
-            //DEBUG_WEBSOCKETS("Receive %d left %d!\n", len, n);
-        } else {
-            //DEBUG_WEBSOCKETS("Receive %d left %d!\n", len, n);
+    // when a part is on the wire the queue was empty so there is space
+    if(sent == 0 && !txQueueMakeRoom(client, left)) {
+        DEBUG_WEBSOCKETS("[WS][%d][write] queue full, frame dropped\n", client->num);
+        queue->stats.dropped++;
+        return 0;
+    }
+
+    // copy the rest in to the ring buffer
+    size_t tail = txQueueWrap(queue->head + queue->bytes);
+    for(uint8_t part = 0; part < 2; part++) {
+        uint8_t * src = (part == 0) ? out : out2;
+        size_t len = (part == 0) ? n : n2;
+        // skip what is already send
+        if(sent >= len) {
+            sent -= len;
+            continue;
+        }
+        src += sent;
+        len -= sent;
+        sent = 0;
+        while(len) {
+            size_t chunk = (WEBSOCKETS_TX_QUEUE_SIZE - tail);
+            if(chunk > len) {
+                chunk = len;
+            }
+            memcpy(&queue->data[tail], src, chunk);
+            tail = txQueueWrap(tail + chunk);
+            src += chunk;
+            len -= chunk;
         }
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
-        delay(0);
-#endif
     }
-    if(cb) {
-        cb(client, true);
+
+    // a frame with a part on the wire can not be dropped any more, the peer would lose sync
+    WSqueueEntry_t * entry = &queue->entry[((queue->first + queue->count) % WEBSOCKETS_TX_QUEUE_DEPTH)];
+    entry->length = left;
+    entry->partial = (left < total);
+    entry->time = millis();
+    queue->bytes += left;
+    queue->count++;
+
+    if(queue->count > queue->stats.highWater) {
+        queue->stats.highWater = queue->count;
     }
-#endif
-    return true;
+
+    return total;
 }
 
 /**
- * write x byte to tcp or get timeout
+ * write x byte to tcp
  * @param client WSclient_t *
  * @param out  uint8_t * data buffer
  * @param n size_t byte count
+ * @param block bool    true: wait until all is send or timeout, false: only send what fits in the TCP window
  * @return bytes send
  */
-size_t WebSockets::write(WSclient_t * client, uint8_t *out, size_t n) {
+size_t WebSockets::writeDirect(WSclient_t * client, uint8_t *out, size_t n, bool block) {
 	if(out == NULL) return 0;
 	if(client == NULL) return 0;
+
+	if(!block) {
+		if(client->tcp == NULL || !client->tcp->connected()) {
+			return 0;
+		}
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
+		size_t room = client->tcp->availableForWrite();
+		if(room == 0) {
+			return 0;
+		}
+		if(n > room) {
+			n = room;
+		}
+#endif
+		return client->tcp->write((const uint8_t*)out, n);
+	}
+
 	unsigned long t = millis();
 	size_t len = 0;
 	size_t total = 0;
@@ -648,8 +1209,191 @@ size_t WebSockets::write(WSclient_t * client, uint8_t *out, size_t n) {
 	return total;
 }
 
-size_t WebSockets::write(WSclient_t * client, const char *out) {
-	if(client == NULL) return 0;
-	if(out == NULL) return 0;
-	return write(client, (uint8_t*)out, strlen(out));
+/**
+ * reserve the send queue of a client
+ * called on connect (or on the first backlog if _txQueueOnDemand), the queue is kept for the lifetime of the client slot
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::txQueueReserve(WSclient_t * client) {
+#if (WEBSOCKETS_TX_QUEUE_SIZE > 0) && (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(!client->txQueue) {
+        client->txQueue = (WSqueue_t *) malloc(sizeof(WSqueue_t) + WEBSOCKETS_TX_QUEUE_SIZE);
+        if(!client->txQueue) {
+            DEBUG_WEBSOCKETS("[WS][%d][txQueueReserve] to less memory, write is blocking!\n", client->num);
+            return;
+        }
+        memset(client->txQueue, 0x00, sizeof(WSqueue_t));
+        client->txQueue->data = (uint8_t *) (client->txQueue + 1);
+    }
+#endif
+    txQueueClear(client);
+}
+
+/**
+ * release the send queue of a client
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::txQueueRelease(WSclient_t * client) {
+    if(client->txQueue) {
+        free(client->txQueue);
+        client->txQueue = NULL;
+    }
+}
+
+/**
+ * drop all waiting data (connection is gone)
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::txQueueClear(WSclient_t * client) {
+    WSqueue_t * queue = client->txQueue;
+    if(queue) {
+        queue->head = 0;
+        queue->bytes = 0;
+        queue->headSent = 0;
+        queue->first = 0;
+        queue->count = 0;
+    }
+}
+
+/**
+ * send waiting data
+ * @param client WSclient_t *  ptr to the client struct
+ * @param block bool    wait until the queue is empty (max WEBSOCKETS_TCP_TIMEOUT)
+ */
+void WebSockets::txFlush(WSclient_t * client, bool block) {
+    WSqueue_t * queue = client->txQueue;
+    if(!queue) {
+        return;
+    }
+
+    unsigned long t = millis();
+    while(queue->count) {
+        WSqueueEntry_t * entry = &queue->entry[queue->first];
+
+        // frames not on the wire yet can expire
+        if(_txQueueMaxAge && !txQueueOnWire(queue) && (millis() - entry->time) > _txQueueMaxAge) {
+            DEBUG_WEBSOCKETS("[WS][%d][txFlush] frame expired (%lums)\n", client->num, (millis() - entry->time));
+            txQueuePop(queue, true);
+            continue;
+        }
+
+        size_t chunk = (entry->length - queue->headSent);
+        if(chunk > (WEBSOCKETS_TX_QUEUE_SIZE - queue->head)) {
+            chunk = (WEBSOCKETS_TX_QUEUE_SIZE - queue->head);
+        }
+
+        size_t len = writeDirect(client, &queue->data[queue->head], chunk, false);
+        if(len) {
+            t = millis();
+            queue->head = txQueueWrap(queue->head + len);
+            queue->bytes -= len;
+            queue->headSent += len;
+            if(queue->headSent == entry->length) {
+                queue->headSent = 0;
+                queue->first = ((queue->first + 1) % WEBSOCKETS_TX_QUEUE_DEPTH);
+                queue->count--;
+            }
+            continue;
+        }
+
+        if(!block || !client->tcp || !client->tcp->connected()) {
+            break;
+        }
+
+        if((millis() - t) > WEBSOCKETS_TCP_TIMEOUT) {
+            DEBUG_WEBSOCKETS("[WS][%d][txFlush] write TIMEOUT! %lu\n", client->num, (millis() - t));
+            break;
+        }
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
+        delay(0);
+#endif
+    }
+}
+
+/**
+ * get the send queue statistic of a client
+ * @param client WSclient_t *  ptr to the client struct
+ * @return WSqueueStats_t
+ */
+WSqueueStats_t WebSockets::txQueueStats(WSclient_t * client) {
+    WSqueueStats_t stats;
+    memset(&stats, 0x00, sizeof(stats));
+
+    WSqueue_t * queue = client->txQueue;
+    if(queue) {
+        stats = queue->stats;
+        stats.entries = queue->count;
+        stats.bytes = queue->bytes;
+        if(queue->count) {
+            stats.oldestAge = (millis() - queue->entry[queue->first].time);
+        }
+    }
+    return stats;
+}
+
+/**
+ * make space for a new frame based on the queue policy
+ * @param client WSclient_t *  ptr to the client struct
+ * @param length size_t     bytes needed
+ * @return true if there is space
+ */
+bool WebSockets::txQueueMakeRoom(WSclient_t * client, size_t length) {
+    WSqueue_t * queue = client->txQueue;
+    unsigned long t = millis();
+    bool waited = false;
+
+    while((queue->bytes + length) > WEBSOCKETS_TX_QUEUE_SIZE || queue->count >= _txQueueDepth) {
+        switch(_txQueuePolicy) {
+            case WSqueue_dropOldest:
+                // the first frame can only go if nothing of it is on the wire
+                if(queue->count == 0 || txQueueOnWire(queue)) {
+                    return false;
+                }
+                txQueuePop(queue, true);
+                break;
+            case WSqueue_block:
+                if(!client->tcp || !client->tcp->connected() || (millis() - t) > WEBSOCKETS_TCP_TIMEOUT) {
+                    return false;
+                }
+                if(!waited) {
+                    queue->stats.blocked++;
+                    waited = true;
+                }
+                txFlush(client);
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
+                delay(0);
+#endif
+                break;
+            case WSqueue_dropNewest:
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * is a part of the first frame already on the wire (written directly or from the queue)
+ * @param queue WSqueue_t *
+ * @return true if the frame has to be send to the end
+ */
+bool WebSockets::txQueueOnWire(WSqueue_t * queue) {
+    return (queue->headSent || queue->entry[queue->first].partial);
+}
+
+/**
+ * remove the first frame from the queue
+ * @param queue WSqueue_t *
+ * @param dropped bool  count as dropped
+ */
+void WebSockets::txQueuePop(WSqueue_t * queue, bool dropped) {
+    size_t left = (queue->entry[queue->first].length - queue->headSent);
+    queue->head = txQueueWrap(queue->head + left);
+    queue->bytes -= left;
+    queue->headSent = 0;
+    queue->first = ((queue->first + 1) % WEBSOCKETS_TX_QUEUE_DEPTH);
+    queue->count--;
+    if(dropped) {
+        queue->stats.dropped++;
+    }
 }
@@ -67,6 +67,13 @@
 #define WEBSOCKETS_USE_BIG_MEM
 #define GET_FREE_HEAP System.freeMemory()
 
+#elif defined(__linux__)
+
+// host build (NETWORK_POSIX)
+#define WEBSOCKETS_MAX_DATA_SIZE (15 * 1024)
+#define WEBSOCKETS_USE_BIG_MEM
+#define GET_FREE_HEAP 0
+
 #else
 
 //atmega328p has only 2KB ram!
@@ -78,15 +85,70 @@
 
 #define WEBSOCKETS_TCP_TIMEOUT (2000)
 
+// payloads up to this size are received into the preallocated pool
+#ifndef WEBSOCKETS_MAX_COMMAND_SIZE
+#define WEBSOCKETS_MAX_COMMAND_SIZE (128)
+#endif
+
+// number of preallocated receive buffers
+#ifndef WEBSOCKETS_RX_POOL_SIZE
+#define WEBSOCKETS_RX_POOL_SIZE (2)
+#endif
+
+// per client send queue (bytes), 0 disables the queue and write() blocks until the data is send
+#ifndef WEBSOCKETS_TX_QUEUE_SIZE
+#ifdef WEBSOCKETS_USE_BIG_MEM
+#define WEBSOCKETS_TX_QUEUE_SIZE (1024)
+#else
+#define WEBSOCKETS_TX_QUEUE_SIZE (0)
+#endif
+#endif
+
+// max frames waiting in the send queue
+#ifndef WEBSOCKETS_TX_QUEUE_DEPTH
+#define WEBSOCKETS_TX_QUEUE_DEPTH (16)
+#endif
+
+// pongs to the last n ping probes count for the round trip time (late answers)
+#ifndef WEBSOCKETS_PING_PROBE_WINDOW
+#define WEBSOCKETS_PING_PROBE_WINDOW (8)
+#endif
+
+// max length of a HTTP header line read by the client, longer lines are cut
+#ifndef WEBSOCKETS_MAX_HEADER_LINE
+#ifdef WEBSOCKETS_USE_BIG_MEM
+#define WEBSOCKETS_MAX_HEADER_LINE (256)
+#else
+#define WEBSOCKETS_MAX_HEADER_LINE (128)
+#endif
+#endif
+
+// base64 length of Sec-WebSocket-Key (16 byte) and Sec-WebSocket-Accept (20 byte)
+#define WEBSOCKETS_KEY_LENGTH (24)
+#define WEBSOCKETS_ACCEPT_LENGTH (28)
+
 #define NETWORK_ESP8266_ASYNC (0)
 #define NETWORK_ESP8266 (1)
 #define NETWORK_W5100 (2)
 #define NETWORK_ENC28J60 (3)
 #define NETWORK_ESP32 (4)
+#define NETWORK_POSIX (5)
 
 // max size of the WS Message Header
 #define WEBSOCKETS_MAX_HEADER_SIZE (14)
 
+// max payload of a frame build in the per client transmit arena (one TCP package)
+#ifndef WEBSOCKETS_TX_ARENA_PAYLOAD
+#define WEBSOCKETS_TX_ARENA_PAYLOAD (1400)
+#endif
+
+// word size used by the XOR masking kernel
+#if defined(__SIZEOF_POINTER__) && (__SIZEOF_POINTER__ == 8)
+#define WEBSOCKETS_MASK_WORD uint64_t
+#else
+#define WEBSOCKETS_MASK_WORD uint32_t
+#endif
+
 #if !defined(WEBSOCKETS_NETWORK_TYPE)
 // select Network type based
 #if defined(ESP8266) || defined(ESP31B)
@@ -117,6 +179,8 @@
 #include <WiFiClientSecure.h>
 #elif defined(ESP31B)
 #include <ESP31BWiFi.h>
+#elif defined(__linux__)
+// host tests, ESPAsyncTCP is an in-memory fake (tests/host/async)
 #else
 #error "network type ESP8266 ASYNC only possible on the ESP mcu!"
 #endif
@@ -165,10 +229,31 @@
 #define WEBSOCKETS_NETWORK_CLASS WiFiClient
 #define WEBSOCKETS_NETWORK_SERVER_CLASS WiFiServer
 
+#elif (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
+
+// Linux host (e.g. bridge stand-in), only selected by build flag
+// the Arduino API comes from host/ (see CMakeLists.txt)
+#if !defined(__linux__)
+#error "network type POSIX only possible on Linux!"
+#endif
+
+#include "WebSocketsPosix.h"
+#define WEBSOCKETS_NETWORK_CLASS WebSocketsPosixClient
+#define WEBSOCKETS_NETWORK_SERVER_CLASS WebSocketsPosixServer
+
 #else
 #error "no network type selected!"
 #endif
 
+// class of WSclient_t::tcp, the event driven AsyncTCPbuffer or the WebSocketsTransport interface
+// (WEBSOCKETS_NETWORK_CLASS wrapped by WebSocketsTransportClient, WebSocketsLoopback, ...)
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+#define WEBSOCKETS_TRANSPORT_CLASS WEBSOCKETS_NETWORK_CLASS
+#else
+#include "WebSocketsTransport.h"
+#define WEBSOCKETS_TRANSPORT_CLASS WebSocketsTransport
+#endif
+
 // moves all Header strings to Flash (~300 Byte)
 #ifdef WEBSOCKETS_SAVE_RAM
 #define WEBSOCKETS_STRING(var) F(var)
@@ -194,6 +279,8 @@ typedef enum
         WStype_FRAGMENT_BIN_START,
         WStype_FRAGMENT,
         WStype_FRAGMENT_FIN,
+        WStype_PING,
+        WStype_PONG,
 } WStype_t;
 
 typedef enum
@@ -224,22 +311,67 @@ typedef struct
         uint8_t *maskKey;
 } WSMessageHeader_t;
 
-typedef struct
+typedef enum
 {
-        uint8_t num; ///< connection number
+        WSqueue_block,      ///< wait (max WEBSOCKETS_TCP_TIMEOUT) until there is space
+        WSqueue_dropNewest, ///< drop the frame that does not fit
+        WSqueue_dropOldest  ///< drop waiting frames that are not on the wire yet to make space
+} WSqueuePolicy_t;
 
-        WSclientsStatus_t status;
+/**
+ * fills the next chunk of a streamed message (sendTXTStream / sendBINStream)
+ * @param buffer uint8_t *  out
+ * @param size size_t  max bytes (the chunk size)
+ * @return bytes written, less then size ends the message
+ */
+#ifdef __AVR__
+typedef size_t (*WSstreamProducer)(uint8_t * buffer, size_t size);
+#else
+typedef std::function<size_t(uint8_t * buffer, size_t size)> WSstreamProducer;
+#endif
 
-        WEBSOCKETS_NETWORK_CLASS *tcp;
+typedef struct
+{
+        uint8_t entries;         ///< frames waiting
+        size_t bytes;            ///< bytes waiting
+        unsigned long oldestAge; ///< ms the oldest frame is waiting
+        uint8_t highWater;       ///< max frames waiting at the same time
+        uint32_t dropped;        ///< frames dropped by policy or age
+        uint32_t blocked;        ///< writes that had to wait for the TCP window
+} WSqueueStats_t;
 
-        bool isSocketIO; ///< client for socket.io server
+typedef struct
+{
+        uint16_t length;    ///< bytes in the queue
+        bool partial;       ///< the frame was partly written before it was queued, length is the rest
+        unsigned long time; ///< millis() when queued
+} WSqueueEntry_t;
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
-        bool isSSL; ///< run in ssl mode
-        WiFiClientSecure *ssl;
-#endif
+typedef struct
+{
+        uint8_t *data;   ///< ring buffer (WEBSOCKETS_TX_QUEUE_SIZE)
+        size_t head;     ///< read position in data
+        size_t bytes;    ///< bytes in data
+        size_t headSent; ///< bytes of the first entry send from the queue
+        WSqueueEntry_t entry[WEBSOCKETS_TX_QUEUE_DEPTH];
+        uint8_t first; ///< index of the first entry
+        uint8_t count; ///< entries in use
+        WSqueueStats_t stats;
+} WSqueue_t;
 
-        String cUrl;    ///< http url
+typedef struct
+{
+        uint32_t hits;   ///< payloads received into a pool buffer
+        uint32_t misses; ///< payloads received into heap memory (oversized or pool exhausted)
+        uint8_t inUse;   ///< pool buffers currently handed out
+} WSpoolStats_t;
+
+/**
+ * HTTP handshake state, only needed until the connection is upgraded
+ * the server takes one from a pool per handshake, the client has one for good (extraHeaders, authorization)
+ */
+typedef struct
+{
         uint16_t cCode; ///< http code
 
         bool cIsUpgrade;   ///< Connection == Upgrade
@@ -252,10 +384,6 @@ typedef struct
         String cExtensions; ///< client Sec-WebSocket-Extensions
         uint16_t cVersion;  ///< client Sec-WebSocket-Version
 
-        uint8_t cWsRXsize;                             ///< State of the RX
-        uint8_t cWsHeader[WEBSOCKETS_MAX_HEADER_SIZE]; ///< RX WS Message buffer
-        WSMessageHeader_t cWsHeaderDecode;
-
         String base64Authorization; ///< Base64 encoded Auth request
         String plainAuthorization;  ///< Base64 encoded Auth request
 
@@ -264,14 +392,53 @@ typedef struct
         bool cHttpHeadersValid;        ///< non-websocket http header validity indicator
         size_t cMandatoryHeadersCount; ///< non-websocket mandatory http headers present count
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-        String cHttpLine; ///< HTTP header lines
+        String cHttpLine; ///< HTTP header line (async and server)
+
+} WSheader_t;
+
+typedef struct
+{
+        uint8_t num; ///< connection number
+
+        WSclientsStatus_t status;
+
+        WEBSOCKETS_TRANSPORT_CLASS *tcp;
+
+        bool isSocketIO; ///< client for socket.io server
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+        bool isSSL; ///< run in ssl mode
+        WebSocketsTransportClient<WiFiClientSecure> *ssl;
 #endif
 
+        String cUrl; ///< http url
+
+        WSheader_t *header; ///< handshake state (server: only while WSC_HEADER)
+
+        uint8_t *txArena; ///< frame build buffer, reserved once on connect (WEBSOCKETS_USE_BIG_MEM only)
+        WSqueue_t *txQueue; ///< send queue, reserved once on connect (WEBSOCKETS_TX_QUEUE_SIZE > 0 only)
+
+        uint8_t cWsRXsize;                             ///< State of the RX
+        uint8_t cWsHeader[WEBSOCKETS_MAX_HEADER_SIZE]; ///< RX WS Message buffer
+        WSMessageHeader_t cWsHeaderDecode;
+
+        uint8_t *cWsPayload;     ///< RX payload buffer of the current frame (incremental parser)
+        size_t cWsPayloadRX;     ///< payload bytes received of the current frame
+        unsigned long cWsRXtime; ///< millis() of the last RX progress inside a frame
+
 } WSclient_t;
 
 class WebSockets
 {
+      public:
+        WebSockets(void);
+
+        static void maskPayload(uint8_t *data, size_t length, const uint8_t *maskKey, size_t offset = 0);
+
+        WSpoolStats_t rxPoolStats(void) { return _rxPoolStats; }
+
+        void setSendQueue(uint8_t depth, unsigned long maxAge = 0, WSqueuePolicy_t policy = WSqueue_block);
+
       protected:
 #ifdef __AVR__
         typedef void (*WSreadWaitCb)(WSclient_t *client, bool ok);
@@ -286,10 +453,15 @@ class WebSockets
 
         void clientDisconnect(WSclient_t *client, uint16_t code, char *reason = NULL, size_t reasonLen = 0);
         bool sendFrame(WSclient_t *client, WSopcode_t opcode, uint8_t *payload = NULL, size_t length = 0, bool mask = false, bool fin = true, bool headerToPayload = false);
+        bool sendStream(WSclient_t *client, WSopcode_t opcode, WSstreamProducer producer, size_t chunkSize, bool mask, bool arena = true);
+
+        static uint8_t frameHeaderSize(size_t length, bool mask);
+        static uint8_t createHeader(uint8_t *headerPtr, WSopcode_t opcode, size_t length, bool mask, const uint8_t *maskKey, bool fin);
 
         void headerDone(WSclient_t *client);
 
-        void handleWebsocket(WSclient_t *client);
+        void handleWebsocket(WSclient_t *client, size_t maxBytes = 0, unsigned long maxTime = 0);
+        void handleWebsocketReset(WSclient_t *client);
 
         bool handleWebsocketWaitFor(WSclient_t *client, size_t size);
         void handleWebsocketCb(WSclient_t *client);
@@ -298,9 +470,45 @@ class WebSockets
         String acceptKey(String &clientKey);
         String base64_encode(uint8_t *data, size_t length);
 
+        static void acceptKey(const char *clientKey, char *accept);
+        static size_t base64_encode(const uint8_t *data, size_t length, char *out);
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
         bool readCb(WSclient_t *client, uint8_t *out, size_t n, WSreadWaitCb cb);
+#else
+        static uint8_t headerSize(WSclient_t *client);
+#endif
         virtual size_t write(WSclient_t *client, uint8_t *out, size_t n);
         size_t write(WSclient_t *client, const char *out);
+        size_t write(WSclient_t *client, uint8_t *out, size_t n, uint8_t *out2, size_t n2);
+        size_t writeDirect(WSclient_t *client, uint8_t *out, size_t n, bool block);
+
+        void txQueueReserve(WSclient_t *client);
+        void txQueueRelease(WSclient_t *client);
+        void txQueueClear(WSclient_t *client);
+        void txFlush(WSclient_t *client, bool block = false);
+        WSqueueStats_t txQueueStats(WSclient_t *client);
+
+        void txArenaReserve(WSclient_t *client);
+        void txArenaRelease(WSclient_t *client);
+
+        uint8_t *rxAlloc(size_t size);
+        void rxFree(uint8_t *buffer);
+
+        bool _txQueueOnDemand; ///< reserve the send queue on the first backlog instead of on connect
+
+      private:
+        bool txQueueMakeRoom(WSclient_t *client, size_t length);
+        void txQueuePop(WSqueue_t *queue, bool dropped);
+        bool txQueueOnWire(WSqueue_t *queue);
+
+        uint8_t _txQueueDepth;
+        unsigned long _txQueueMaxAge;
+        WSqueuePolicy_t _txQueuePolicy;
+
+        uint8_t _rxPool[WEBSOCKETS_RX_POOL_SIZE][WEBSOCKETS_MAX_COMMAND_SIZE + 1]; ///< +1 for the text terminator
+        bool _rxPoolUsed[WEBSOCKETS_RX_POOL_SIZE];
+        WSpoolStats_t _rxPoolStats;
 };
 
 #ifndef UNUSED
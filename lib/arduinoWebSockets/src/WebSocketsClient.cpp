@@ -28,17 +28,53 @@
 WebSocketsClient::WebSocketsClient() {
     _cbEvent = NULL;
     _client.num = 0;
-    _client.extraHeaders = WEBSOCKETS_STRING("Origin: file://");
+    _client.tcp = NULL;
+    _client.txArena = NULL;
+    _client.txQueue = NULL;
+    _client.cWsPayload = NULL;
+    _client.cWsRXsize = 0;
+    _client.header = &_header;
+    _client.header->extraHeaders = WEBSOCKETS_STRING("Origin: file://");
+    _handshake = NULL;
+    _handshakeLength = 0;
+    _handshakeKeyPos = 0;
+    _key[0] = 0;
+    _accept[0] = 0;
+    _acceptValid = false;
+    _pingInterval = 0;
+    _pingLast = 0;
+    _pingSeq = 0;
+    _pingRTT = 0;
+    _pingPending = 0;
+    _pingWaiting = false;
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    _headerLineLength = 0;
+#endif
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    _asyncConnecting = false;
+    _asyncReconnect = false;
+#endif
 }
 
 WebSocketsClient::~WebSocketsClient() {
     disconnect();
+    txArenaRelease(&_client);
+    txQueueRelease(&_client);
+    handshakeRelease();
 }
 
 /**
  * calles to init the Websockets server
  */
 void WebSocketsClient::begin(const char *host, uint16_t port, const char * url, const char * protocol) {
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    // begin may be called again (e.g. after WiFi reconnect), drop the old connection first
+    if(_client.tcp) {
+        clientDisconnect(&_client);
+    }
+    _asyncReconnect = false;
+#endif
+
     _host = host;
     _port = port;
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
@@ -53,16 +89,17 @@ void WebSocketsClient::begin(const char *host, uint16_t port, const char * url,
     _client.ssl = NULL;
 #endif
     _client.cUrl = url;
-    _client.cCode = 0;
-    _client.cIsUpgrade = false;
-    _client.cIsWebsocket = true;
-    _client.cKey = "";
-    _client.cAccept = "";
-    _client.cProtocol = protocol;
-    _client.cExtensions = "";
-    _client.cVersion = 0;
-    _client.base64Authorization = "";
-    _client.plainAuthorization = "";
+    handshakeRelease();
+    _client.header->cCode = 0;
+    _client.header->cIsUpgrade = false;
+    _client.header->cIsWebsocket = true;
+    _client.header->cKey = "";
+    _client.header->cAccept = "";
+    _client.header->cProtocol = protocol;
+    _client.header->cExtensions = "";
+    _client.header->cVersion = 0;
+    _client.header->base64Authorization = "";
+    _client.header->plainAuthorization = "";
     _client.isSocketIO = false;
 
 #ifdef ESP8266
@@ -71,12 +108,19 @@ void WebSocketsClient::begin(const char *host, uint16_t port, const char * url,
     // todo find better seed
     randomSeed(millis());
 #endif
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-    asyncConnect();
-#endif
-
     _lastConnectionFail = 0;
     _reconnectInterval = 500;
+    _reconnectMaxInterval = 0;
+    _reconnectDelay = 0;
+    _reconnectJitter = 0;
+    _reconnectFails = 0;
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    // a connect still in flight will use the new host / url when done
+    if(!_asyncConnecting) {
+        asyncConnect();
+    }
+#endif
 }
 
 void WebSocketsClient::begin(String host, uint16_t port, String url, String protocol) {
@@ -121,14 +165,35 @@ void WebSocketsClient::beginSocketIOSSL(String host, uint16_t port, String url,
 }
 #endif
 
-#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+/**
+ * called in arduino loop
+ * data and connect events are handled in the ESPAsyncTCP callbacks,
+ * the loop only starts the reconnect after the reconnect interval
+ */
+void WebSocketsClient::loop(void) {
+    handlePingProbe();
+
+    if(!_asyncReconnect || _asyncConnecting || _client.tcp) {
+        return;
+    }
+
+    // do not flood the server
+    if((millis() - _lastConnectionFail) < _reconnectDelay) {
+        return;
+    }
+
+    _asyncReconnect = false;
+    asyncConnect();
+}
+#else
 /**
  * called in arduino loop
  */
 void WebSocketsClient::loop(void) {
     if(!clientIsConnected(&_client)) {
         // do not flood the server
-        if((millis() - _lastConnectionFail) < _reconnectInterval) {
+        if((millis() - _lastConnectionFail) < _reconnectDelay) {
             return;
         }
 
@@ -140,19 +205,18 @@ void WebSocketsClient::loop(void) {
                 _client.ssl = NULL;
                 _client.tcp = NULL;
             }
-            _client.ssl = new WiFiClientSecure();
+            _client.ssl = new WebSocketsTransportClient<WiFiClientSecure>();
             _client.tcp = _client.ssl;
-        } else {
+        } else
+#endif
+        {
             DEBUG_WEBSOCKETS("[WS-Client] connect ws...\n");
             if(_client.tcp) {
                 delete _client.tcp;
                 _client.tcp = NULL;
             }
-            _client.tcp = new WiFiClient();
+            _client.tcp = createTransport();
         }
-#else
-        _client.tcp = new WEBSOCKETS_NETWORK_CLASS();
-#endif
 
         if(!_client.tcp) {
             DEBUG_WEBSOCKETS("[WS-Client] creating Network class failed!");
@@ -164,15 +228,35 @@ void WebSocketsClient::loop(void) {
             _lastConnectionFail = 0;
         } else {
             connectFailedCb();
-            _lastConnectionFail = millis();
-
         }
     } else {
         handleClientData();
+        txFlush(&_client);
+        handlePingProbe();
     }
 }
 #endif
 
+/**
+ * send the next ping probe when the interval is over
+ */
+void WebSocketsClient::handlePingProbe(void) {
+    if(_pingInterval && (millis() - _pingLast) >= _pingInterval && _client.status == WSC_CONNECTED) {
+        sendPingProbe();
+    }
+}
+
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * create the transport for the next connect, called by loop()
+ * override to run the client over something else, e.g. a WebSocketsLoopback
+ * @return WebSocketsTransport *  owned (and deleted) by the client
+ */
+WebSocketsTransport * WebSocketsClient::createTransport(void) {
+    return new WebSocketsTransportClient<WEBSOCKETS_NETWORK_CLASS>();
+}
+#endif
+
 /**
  * set callback function
  * @param cbEvent WebSocketServerEvent
@@ -234,6 +318,26 @@ bool WebSocketsClient::sendBIN(const uint8_t * payload, size_t length) {
     return sendBIN((uint8_t *) payload, length);
 }
 
+/**
+ * send a big message as fragments, chunk by chunk from the producer
+ * @param producer WSstreamProducer  fills the next chunk, less then chunkSize ends the message
+ * @param chunkSize size_t  max payload per frame, up to WEBSOCKETS_TX_ARENA_PAYLOAD no extra RAM is needed
+ * @return true if ok
+ */
+bool WebSocketsClient::sendTXTStream(WSstreamProducer producer, size_t chunkSize) {
+    if(clientIsConnected(&_client)) {
+        return sendStream(&_client, WSop_text, producer, chunkSize, true);
+    }
+    return false;
+}
+
+bool WebSocketsClient::sendBINStream(WSstreamProducer producer, size_t chunkSize) {
+    if(clientIsConnected(&_client)) {
+        return sendStream(&_client, WSop_binary, producer, chunkSize, true);
+    }
+    return false;
+}
+
 /**
  * sends a WS ping to Server
  * @param payload uint8_t *
@@ -251,6 +355,57 @@ bool WebSocketsClient::sendPing(String & payload) {
     return sendPing((uint8_t *) payload.c_str(), payload.length());
 }
 
+/**
+ * send a ping with sequence number and micros() as payload,
+ * the pong is matched in messageReceived, see pingRTT()
+ * @return true if ok
+ */
+bool WebSocketsClient::sendPingProbe(void) {
+    if(!clientIsConnected(&_client) || _client.status != WSC_CONNECTED) {
+        return false;
+    }
+    uint32_t now = micros();
+    _pingSeq++;
+    memcpy(&_pingProbe[0], &_pingSeq, sizeof(_pingSeq));
+    memcpy(&_pingProbe[sizeof(_pingSeq)], &now, sizeof(now));
+    _pingLast = millis();
+    if(!_pingWaiting) {
+        _pingWaiting = true;
+        _pingPending = _pingLast;
+    }
+    return sendFrame(&_client, WSop_ping, _pingProbe, sizeof(_pingProbe), true);
+}
+
+/**
+ * send a ping probe from loop() every interval ms
+ * @param interval unsigned long  0 = off
+ */
+void WebSocketsClient::setPingProbe(unsigned long interval) {
+    _pingInterval = interval;
+}
+
+/**
+ * round trip time of the ping probe answered by the last pong,
+ * read it in the WStype_PONG event
+ * @return us, 0 if the last pong was no answer to a probe
+ */
+uint32_t WebSocketsClient::pingRTT(void) {
+    return _pingRTT;
+}
+
+/**
+ * time since the oldest probe that is not answered yet was send,
+ * works without send queue as well (async): a dead link without close shows up here
+ * @return ms, 0 if every probe is answered
+ */
+unsigned long WebSocketsClient::pingSilence(void) {
+    if(!_pingWaiting) {
+        return 0;
+    }
+    unsigned long silence = (millis() - _pingPending);
+    return silence ? silence : 1;
+}
+
 /**
  * disconnect one client
  * @param num uint8_t client id
@@ -271,7 +426,8 @@ void WebSocketsClient::setAuthorization(const char * user, const char * password
         String auth = user;
         auth += ":";
         auth += password;
-        _client.base64Authorization = base64_encode((uint8_t *) auth.c_str(), auth.length());
+        _client.header->base64Authorization = base64_encode((uint8_t *) auth.c_str(), auth.length());
+        handshakeRelease();
     }
 }
 
@@ -281,8 +437,9 @@ void WebSocketsClient::setAuthorization(const char * user, const char * password
  */
 void WebSocketsClient::setAuthorization(const char * auth) {
     if(auth) {
-        //_client.base64Authorization = auth;
-        _client.plainAuthorization = auth;
+        //_client.header->base64Authorization = auth;
+        _client.header->plainAuthorization = auth;
+        handshakeRelease();
     }
 }
 
@@ -292,7 +449,16 @@ void WebSocketsClient::setAuthorization(const char * auth) {
  * @param extraHeaders const char * extraHeaders
  */
 void WebSocketsClient::setExtraHeaders(const char * extraHeaders) {
-    _client.extraHeaders = extraHeaders;
+    _client.header->extraHeaders = extraHeaders;
+    handshakeRelease();
+}
+
+/**
+ * get the send queue statistic
+ * @return WSqueueStats_t
+ */
+WSqueueStats_t WebSocketsClient::sendQueueStats(void) {
+    return txQueueStats(&_client);
 }
 
 /**
@@ -304,6 +470,32 @@ void WebSocketsClient::setReconnectInterval(unsigned long time) {
     _reconnectInterval = time;
 }
 
+/**
+ * set the reconnect backoff
+ * the wait time starts at the reconnect interval and doubles
+ * with every failed attempt up to maxInterval
+ * @param maxInterval unsigned long  max wait time in ms (0 = no backoff)
+ * @param jitter uint8_t  random +- part of the wait time in percent
+ */
+void WebSocketsClient::setReconnectBackoff(unsigned long maxInterval, uint8_t jitter) {
+    _reconnectMaxInterval = maxInterval;
+    _reconnectJitter = (jitter > 100) ? 100 : jitter;
+}
+
+/**
+ * forget the failed attempts and connect on the next loop(),
+ * e.g. when the network link is back
+ */
+void WebSocketsClient::reconnectNow(void) {
+    _reconnectFails = 0;
+    _reconnectDelay = 0;
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    if(!_client.tcp && !_asyncConnecting) {
+        _asyncReconnect = true;
+    }
+#endif
+}
+
 //#################################################################################
 //#################################################################################
 //#################################################################################
@@ -330,9 +522,29 @@ void WebSocketsClient::messageReceived(WSclient_t * client, WSopcode_t opcode, u
         case WSop_continuation:
             type = fin ? WStype_FRAGMENT_FIN : WStype_FRAGMENT;
             break;
-        case WSop_close:
         case WSop_ping:
+            type = WStype_PING;
+            break;
         case WSop_pong:
+            type = WStype_PONG;
+            _pingRTT = 0;
+            // answer to one of the last probes? late answers still count, the time is in the payload
+            if(length == sizeof(_pingProbe)) {
+                uint16_t seq;
+                uint32_t sent;
+                memcpy(&seq, payload, sizeof(seq));
+                memcpy(&sent, payload + sizeof(seq), sizeof(sent));
+                if((uint16_t) (_pingSeq - seq) < WEBSOCKETS_PING_PROBE_WINDOW) {
+                    // the link is alive, probes send before are late, not lost
+                    _pingWaiting = false;
+                    _pingRTT = micros() - sent;
+                    if(_pingRTT == 0) {
+                        _pingRTT = 1;
+                    }
+                }
+            }
+            break;
+        case WSop_close:
         default:
             break;
     }
@@ -348,6 +560,8 @@ void WebSocketsClient::messageReceived(WSclient_t * client, WSopcode_t opcode, u
 void WebSocketsClient::clientDisconnect(WSclient_t * client) {
 
     bool event = false;
+    // connection lost before the handshake was done
+    bool failed = (client->status == WSC_HEADER);
 
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
     if(client->isSSL && client->ssl) {
@@ -362,32 +576,54 @@ void WebSocketsClient::clientDisconnect(WSclient_t * client) {
     }
 #endif
 
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    if(client->tcp) {
+        // detach first, the disconnect callback of stop() then only frees the AsyncTCPbuffer
+        AsyncTCPbuffer * tcp = client->tcp;
+        client->tcp = NULL;
+        if(tcp->connected()) {
+            tcp->stop();
+        }
+        event = true;
+    }
+    if(client->status != WSC_NOT_CONNECTED) {
+        event = true;
+    }
+#else
     if(client->tcp) {
         if(client->tcp->connected()) {
-#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
             client->tcp->flush();
-#endif
             client->tcp->stop();
         }
         event = true;
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-        client->status = WSC_NOT_CONNECTED;
-#else
         delete client->tcp;
-#endif
         client->tcp = NULL;
     }
+#endif
+
+    txQueueClear(client);
+    handleWebsocketReset(client);
+    _pingWaiting = false;
 
-    client->cCode = 0;
-    client->cKey = "";
-    client->cAccept = "";
-    client->cVersion = 0;
-    client->cIsUpgrade = false;
-    client->cIsWebsocket = false;
-    client->cSessionId = "";
+    client->header->cCode = 0;
+    client->header->cKey = "";
+    client->header->cAccept = "";
+    client->header->cVersion = 0;
+    client->header->cIsUpgrade = false;
+    client->header->cIsWebsocket = false;
+    client->header->cSessionId = "";
 
     client->status = WSC_NOT_CONNECTED;
 
+    if(failed) {
+        connectFailedCb();
+    }
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    // reconnect is started from loop() after the reconnect delay
+    asyncReconnect();
+#endif
+
     DEBUG_WEBSOCKETS("[WS-Client] client disconnected.\n");
     if(event) {
         runCbEvent(WStype_DISCONNECTED, NULL, 0);
@@ -430,21 +666,26 @@ bool WebSocketsClient::clientIsConnected(WSclient_t * client) {
  * Handel incomming data from Client
  */
 void WebSocketsClient::handleClientData(void) {
-    int len = _client.tcp->available();
-    if(len > 0) {
-        switch(_client.status) {
-            case WSC_HEADER: {
-                String headerLine = _client.tcp->readStringUntil('\n');
-                handleHeader(&_client, &headerLine);
-            }
-                break;
-            case WSC_CONNECTED:
-                WebSockets::handleWebsocket(&_client);
-                break;
-            default:
-                WebSockets::clientDisconnect(&_client, 1002);
+    if(_client.status == WSC_CONNECTED) {
+        // reads what is there, keeps the frame state until the next call
+        WebSockets::handleWebsocket(&_client);
+    } else if(_client.status == WSC_HEADER) {
+        // collect the header line by line, a partial line waits for the next call
+        while(_client.tcp && _client.status == WSC_HEADER && _client.tcp->available() > 0) {
+            int c = _client.tcp->read();
+            if(c < 0) {
                 break;
+            }
+            if(c == '\n') {
+                size_t length = _headerLineLength;
+                _headerLineLength = 0;
+                handleHeader(&_client, &_headerLine[0], length);
+            } else if(_headerLineLength < (sizeof(_headerLine) - 1)) {
+                _headerLine[_headerLineLength++] = c;
+            }
         }
+    } else if(_client.tcp->available() > 0) {
+        WebSockets::clientDisconnect(&_client, 1002);
     }
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
     delay(0);
@@ -453,38 +694,26 @@ void WebSocketsClient::handleClientData(void) {
 #endif
 
 /**
- * send the WebSocket header to Server
+ * build the HTTP upgrade request
  * @param client WSclient_t *  ptr to the client struct
+ * @param key const char *  Sec-WebSocket-Key
+ * @return request
  */
-void WebSocketsClient::sendHeader(WSclient_t * client) {
+String WebSocketsClient::buildHeader(WSclient_t * client, const char * key) {
 
     static const char * NEW_LINE = "\r\n";
 
-    DEBUG_WEBSOCKETS("[WS-Client][sendHeader] sending header...\n");
-
-    uint8_t randomKey[16] = { 0 };
-
-    for(uint8_t i = 0; i < sizeof(randomKey); i++) {
-        randomKey[i] = random(0xFF);
-    }
-
-    client->cKey = base64_encode(&randomKey[0], 16);
-
-#ifndef NODEBUG_WEBSOCKETS
-    unsigned long start = micros();
-#endif
-
     String handshake;
     bool ws_header = true;
     String url = client->cUrl;
 
     if(client->isSocketIO) {
-        if(client->cSessionId.length() == 0) {
+        if(client->header->cSessionId.length() == 0) {
             url += WEBSOCKETS_STRING("&transport=polling");
             ws_header = false;
         } else {
             url += WEBSOCKETS_STRING("&transport=websocket&sid=");
-            url += client->cSessionId;
+            url += client->header->cSessionId;
         }
     }
 
@@ -498,128 +727,230 @@ void WebSocketsClient::sendHeader(WSclient_t * client) {
                 "Upgrade: websocket\r\n"
                 "Sec-WebSocket-Version: 13\r\n"
                 "Sec-WebSocket-Key: ");
-        handshake += client->cKey + NEW_LINE;
+        handshake += key;
+        handshake += NEW_LINE;
 
-        if(client->cProtocol.length() > 0) {
+        if(client->header->cProtocol.length() > 0) {
             handshake += WEBSOCKETS_STRING("Sec-WebSocket-Protocol: ");
-            handshake += client->cProtocol + NEW_LINE;
+            handshake += client->header->cProtocol + NEW_LINE;
         }
 
-        if(client->cExtensions.length() > 0) {
+        if(client->header->cExtensions.length() > 0) {
             handshake += WEBSOCKETS_STRING("Sec-WebSocket-Extensions: ");
-            handshake += client->cExtensions + NEW_LINE;
+            handshake += client->header->cExtensions + NEW_LINE;
         }
     } else {
         handshake += WEBSOCKETS_STRING("Connection: keep-alive\r\n");
     }
 
     // add extra headers; by default this includes "Origin: file://"
-    if(client->extraHeaders) {
-        handshake += client->extraHeaders + NEW_LINE;
+    if(client->header->extraHeaders) {
+        handshake += client->header->extraHeaders + NEW_LINE;
     }
 
     handshake += WEBSOCKETS_STRING("User-Agent: arduino-WebSocket-Client\r\n");
 
-    if(client->base64Authorization.length() > 0) {
+    if(client->header->base64Authorization.length() > 0) {
         handshake += WEBSOCKETS_STRING("Authorization: Basic ");
-        handshake += client->base64Authorization + NEW_LINE;
+        handshake += client->header->base64Authorization + NEW_LINE;
     }
 
-    if(client->plainAuthorization.length() > 0) {
+    if(client->header->plainAuthorization.length() > 0) {
         handshake += WEBSOCKETS_STRING("Authorization: ");
-        handshake += client->plainAuthorization + NEW_LINE;
+        handshake += client->header->plainAuthorization + NEW_LINE;
     }
 
     handshake += NEW_LINE;
 
-    DEBUG_WEBSOCKETS("[WS-Client][sendHeader] handshake %s", (uint8_t* )handshake.c_str());
-    write(client, (uint8_t*) handshake.c_str(), handshake.length());
+    return handshake;
+}
+
+/**
+ * free the rendered upgrade request, needed after a change of url, host or headers
+ */
+void WebSocketsClient::handshakeRelease(void) {
+    if(_handshake) {
+        free(_handshake);
+        _handshake = NULL;
+    }
+    _handshakeLength = 0;
+    _handshakeKeyPos = 0;
+}
+
+/**
+ * send the WebSocket header to Server
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSocketsClient::sendHeader(WSclient_t * client) {
+
+    DEBUG_WEBSOCKETS("[WS-Client][sendHeader] sending header...\n");
+
+    uint8_t randomKey[16] = { 0 };
+
+    for(uint8_t i = 0; i < sizeof(randomKey); i++) {
+        randomKey[i] = random(0xFF);
+    }
+
+    base64_encode(&randomKey[0], sizeof(randomKey), &_key[0]);
+    acceptKey(&_key[0], &_accept[0]);
+    _acceptValid = false;
+
+#ifndef NODEBUG_WEBSOCKETS
+    unsigned long start = micros();
+#endif
+
+    if(client->isSocketIO) {
+        // url changes with the session id
+        String handshake = buildHeader(client, &_key[0]);
+        DEBUG_WEBSOCKETS("[WS-Client][sendHeader] handshake %s", (uint8_t* )handshake.c_str());
+        write(client, (uint8_t*) handshake.c_str(), handshake.length());
+    } else {
+        if(!_handshake) {
+            // render once, only the key changes per connect
+            String handshake = buildHeader(client, &_key[0]);
+            int keyPos = handshake.indexOf(WEBSOCKETS_STRING("Sec-WebSocket-Key: "));
+            _handshake = (char *) malloc(handshake.length() + 1);
+            if(_handshake && keyPos >= 0) {
+                memcpy(_handshake, handshake.c_str(), handshake.length() + 1);
+                _handshakeLength = handshake.length();
+                _handshakeKeyPos = keyPos + 19;
+            } else {
+                DEBUG_WEBSOCKETS("[WS-Client][sendHeader] no memory for handshake!\n");
+                handshakeRelease();
+                WebSockets::clientDisconnect(client, 1011);
+                return;
+            }
+        }
+
+        memcpy(&_handshake[_handshakeKeyPos], &_key[0], WEBSOCKETS_KEY_LENGTH);
+
+        DEBUG_WEBSOCKETS("[WS-Client][sendHeader] handshake %s", _handshake);
+        write(client, (uint8_t*) _handshake, _handshakeLength);
+    }
 
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-    client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsClient::handleHeader, this, client, &(client->cHttpLine)));
+    client->tcp->readStringUntil('\n', &(client->header->cHttpLine), std::bind((void (WebSocketsClient::*)(WSclient_t *, String *)) &WebSocketsClient::handleHeader, this, client, &(client->header->cHttpLine)));
 #endif
 
     DEBUG_WEBSOCKETS("[WS-Client][sendHeader] sending header... Done (%luus).\n", (micros() - start));
 
 }
 
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
 /**
- * handle the WebSocket header reading
+ * handle a header line read by AsyncTCPbuffer
  * @param client WSclient_t *  ptr to the client struct
+ * @param headerLine String *
  */
 void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
-
     headerLine->trim(); // remove \r
+    bool more = (headerLine->length() > 0);
 
-    if(headerLine->length() > 0) {
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader] RX: %s\n", headerLine->c_str());
+    // parsed in place in a copy, like the sync path (long lines are cut)
+    size_t length = headerLine->length();
+    if(length > (sizeof(_headerLine) - 1)) {
+        length = sizeof(_headerLine) - 1;
+    }
+    memcpy(&_headerLine[0], headerLine->c_str(), length);
+    handleHeader(client, &_headerLine[0], length);
+
+    if(more) {
+        (*headerLine) = "";
+        if(client->tcp) {
+            client->tcp->readStringUntil('\n', &(client->header->cHttpLine), std::bind((void (WebSocketsClient::*)(WSclient_t *, String *)) &WebSocketsClient::handleHeader, this, client, &(client->header->cHttpLine)));
+        }
+    }
+}
+#endif
 
-        if(headerLine->startsWith(WEBSOCKETS_STRING("HTTP/1."))) {
+/**
+ * handle the WebSocket header reading
+ * @param client WSclient_t *  ptr to the client struct
+ * @param headerLine char *  one line without \n, changed while parsing
+ * @param length size_t
+ */
+void WebSocketsClient::handleHeader(WSclient_t * client, char * headerLine, size_t length) {
+
+    // remove \r
+    while(length > 0 && (headerLine[length - 1] == '\r' || headerLine[length - 1] == ' ')) {
+        length--;
+    }
+    headerLine[length] = 0;
+
+    if(length > 0) {
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader] RX: %s\n", headerLine);
+
+        char * headerValue = strchr(headerLine, ':');
+
+        if(strncmp(headerLine, "HTTP/1.", 7) == 0) {
             // "HTTP/1.1 101 Switching Protocols"
-            client->cCode = headerLine->substring(9, headerLine->indexOf(' ', 9)).toInt();
-        } else if(headerLine->indexOf(':')) {
-            String headerName = headerLine->substring(0, headerLine->indexOf(':'));
-            String headerValue = headerLine->substring(headerLine->indexOf(':') + 1);
+            client->header->cCode = (length > 9) ? atoi(&headerLine[9]) : 0;
+        } else if(headerValue) {
+            // headerLine is the name from here on
+            *headerValue++ = 0;
 
             // remove space in the beginning  (RFC2616)
-            if(headerValue[0] == ' ') {
-                headerValue.remove(0, 1);
+            if(*headerValue == ' ') {
+                headerValue++;
             }
 
-            if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Connection"))) {
-                if(headerValue.equalsIgnoreCase(WEBSOCKETS_STRING("upgrade"))) {
-                    client->cIsUpgrade = true;
+            if(strcasecmp(headerLine, "Connection") == 0) {
+                if(strcasecmp(headerValue, "upgrade") == 0) {
+                    client->header->cIsUpgrade = true;
                 }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Upgrade"))) {
-                if(headerValue.equalsIgnoreCase(WEBSOCKETS_STRING("websocket"))) {
-                    client->cIsWebsocket = true;
+            } else if(strcasecmp(headerLine, "Upgrade") == 0) {
+                if(strcasecmp(headerValue, "websocket") == 0) {
+                    client->header->cIsWebsocket = true;
                 }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Accept"))) {
-                client->cAccept = headerValue;
-                client->cAccept.trim(); // see rfc6455
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Protocol"))) {
-                client->cProtocol = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Extensions"))) {
-                client->cExtensions = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Version"))) {
-                client->cVersion = headerValue.toInt();
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Set-Cookie"))) {
-                if(headerValue.indexOf(WEBSOCKETS_STRING("HttpOnly")) > -1) {
-                    client->cSessionId = headerValue.substring(headerValue.indexOf('=') + 1, headerValue.indexOf(";"));
-                } else {
-                    client->cSessionId = headerValue.substring(headerValue.indexOf('=') + 1);
+            } else if(strcasecmp(headerLine, "Sec-WebSocket-Accept") == 0) {
+                while(*headerValue == ' ') {
+                    headerValue++; // see rfc6455
+                }
+                _acceptValid = (strcmp(headerValue, &_accept[0]) == 0);
+            } else if(strcasecmp(headerLine, "Sec-WebSocket-Protocol") == 0) {
+                client->header->cProtocol = headerValue;
+            } else if(strcasecmp(headerLine, "Sec-WebSocket-Extensions") == 0) {
+                client->header->cExtensions = headerValue;
+            } else if(strcasecmp(headerLine, "Sec-WebSocket-Version") == 0) {
+                client->header->cVersion = atoi(headerValue);
+            } else if(strcasecmp(headerLine, "Set-Cookie") == 0) {
+                char * sessionId = strchr(headerValue, '=');
+                if(sessionId) {
+                    sessionId++;
+                    if(strstr(headerValue, "HttpOnly")) {
+                        char * end = strchr(sessionId, ';');
+                        if(end) {
+                            *end = 0;
+                        }
+                    }
+                    client->header->cSessionId = sessionId;
                 }
             }
         } else {
-            DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header error (%s)\n", headerLine->c_str());
+            DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header error (%s)\n", headerLine);
         }
 
-        (*headerLine) = "";
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-        client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsClient::handleHeader, this, client, &(client->cHttpLine)));
-#endif
-
     } else {
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header read fin.\n");
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Client settings:\n");
 
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cURL: %s\n", client->cUrl.c_str());
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cKey: %s\n", client->cKey.c_str());
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cKey: %s\n", &_key[0]);
 
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Server header:\n");
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cCode: %d\n", client->cCode);
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cIsUpgrade: %d\n", client->cIsUpgrade);
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cIsWebsocket: %d\n", client->cIsWebsocket);
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cAccept: %s\n", client->cAccept.c_str());
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cProtocol: %s\n", client->cProtocol.c_str());
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cExtensions: %s\n", client->cExtensions.c_str());
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cVersion: %d\n", client->cVersion);
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cSessionId: %s\n", client->cSessionId.c_str());
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cCode: %d\n", client->header->cCode);
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cIsUpgrade: %d\n", client->header->cIsUpgrade);
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cIsWebsocket: %d\n", client->header->cIsWebsocket);
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cAccept valid: %d\n", _acceptValid);
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cProtocol: %s\n", client->header->cProtocol.c_str());
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cExtensions: %s\n", client->header->cExtensions.c_str());
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cVersion: %d\n", client->header->cVersion);
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cSessionId: %s\n", client->header->cSessionId.c_str());
 
-        bool ok = (client->cIsUpgrade && client->cIsWebsocket);
+        bool ok = (client->header->cIsUpgrade && client->header->cIsWebsocket);
 
         if(ok) {
-            switch(client->cCode) {
+            switch(client->header->cCode) {
                 case 101:  ///< Switching Protocols
 
                     break;
@@ -631,25 +962,16 @@ void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
                     // todo handle login
                 default:   ///< Server dont unterstand requrst
                     ok = false;
-                    DEBUG_WEBSOCKETS("[WS-Client][handleHeader] serverCode is not 101 (%d)\n", client->cCode);
+                    DEBUG_WEBSOCKETS("[WS-Client][handleHeader] serverCode is not 101 (%d)\n", client->header->cCode);
                     clientDisconnect(client);
-                    _lastConnectionFail = millis();
                     break;
             }
         }
 
-        if(ok) {
-
-            if(client->cAccept.length() == 0) {
-                ok = false;
-            } else {
-                // generate Sec-WebSocket-Accept key for check
-                String sKey = acceptKey(client->cKey);
-                if(sKey != client->cAccept) {
-                    DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Sec-WebSocket-Accept is wrong\n");
-                    ok = false;
-                }
-            }
+        // Sec-WebSocket-Accept is checked against the key precomputed in sendHeader
+        if(ok && !_acceptValid) {
+            DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Sec-WebSocket-Accept is missing or wrong\n");
+            ok = false;
         }
 
         if(ok) {
@@ -657,13 +979,16 @@ void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
             DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Websocket connection init done.\n");
             headerDone(client);
 
+            // connected, next reconnect starts without backoff
+            _reconnectFails = 0;
+            _reconnectDelay = 0;
+
             runCbEvent(WStype_CONNECTED, (uint8_t *) client->cUrl.c_str(), client->cUrl.length());
 
-        } else if(clientIsConnected(client) && client->isSocketIO && client->cSessionId.length() > 0) {
+        } else if(clientIsConnected(client) && client->isSocketIO && client->header->cSessionId.length() > 0) {
             sendHeader(client);
         } else {
             DEBUG_WEBSOCKETS("[WS-Client][handleHeader] no Websocket connection close.\n");
-            _lastConnectionFail = millis();
             if(clientIsConnected(client)) {
                 write(client, "This is a webSocket client!");
             }
@@ -678,18 +1003,26 @@ void WebSocketsClient::connectedCb() {
 
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     _client.tcp->onDisconnect(std::bind([](WebSocketsClient * c, AsyncTCPbuffer * obj, WSclient_t * client) -> bool {
-                        DEBUG_WEBSOCKETS("[WS-Server][%d] Disconnect client\n", client->num);
-                        client->status = WSC_NOT_CONNECTED;
-                        client->tcp = NULL;
+                        DEBUG_WEBSOCKETS("[WS-Client] Disconnect client\n");
 
-                        // reconnect
-                        c->asyncConnect();
+                        // connection closed by the server or the network
+                        if(client->tcp == obj) {
+                            // AsyncTCPbuffer is deleted by the return value
+                            client->tcp = NULL;
+                            c->clientDisconnect(client);
+                        }
 
                         return true;
                     }, this, std::placeholders::_1, &_client));
 #endif
 
     _client.status = WSC_HEADER;
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    _headerLineLength = 0;
+#endif
+
+    txArenaReserve(&_client);
+    txQueueReserve(&_client);
 
 #if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
     // set Timeout for readBytesUntil and readStringUntil
@@ -700,7 +1033,7 @@ void WebSocketsClient::connectedCb() {
     _client.tcp->setNoDelay(true);
 
     if(_client.isSSL && _fingerprint.length()) {
-        if(!_client.ssl->verify(_fingerprint.c_str(), _host.c_str())) {
+        if(!_client.ssl->client().verify(_fingerprint.c_str(), _host.c_str())) {
             DEBUG_WEBSOCKETS("[WS-Client] certificate mismatch\n");
             WebSockets::clientDisconnect(&_client, 1000);
             return;
@@ -715,6 +1048,30 @@ void WebSocketsClient::connectedCb() {
 
 void WebSocketsClient::connectFailedCb() {
     DEBUG_WEBSOCKETS("[WS-Client] connection to %s:%u Faild\n", _host.c_str(), _port);
+
+    // exponential backoff from _reconnectInterval up to _reconnectMaxInterval
+    unsigned long maxWait = (_reconnectMaxInterval > _reconnectInterval) ? _reconnectMaxInterval : _reconnectInterval;
+    unsigned long wait = _reconnectInterval;
+    for(uint8_t i = 0; i < _reconnectFails && wait < maxWait; i++) {
+        wait <<= 1;
+    }
+    if(wait > maxWait) {
+        wait = maxWait;
+    }
+
+    // jitter, so many nodes do not hit the server at the same time
+    if(_reconnectJitter) {
+        unsigned long j = (wait * _reconnectJitter) / 100;
+        wait = wait - j + random(2 * j + 1);
+    }
+
+    if(_reconnectFails < 0xFF) {
+        _reconnectFails++;
+    }
+    _reconnectDelay = wait;
+    _lastConnectionFail = millis();
+
+    DEBUG_WEBSOCKETS("[WS-Client] reconnect in %lu ms (fail %u)\n", _reconnectDelay, _reconnectFails);
 }
 
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
@@ -727,36 +1084,56 @@ void WebSocketsClient::asyncConnect() {
 
     if(!tcpclient) {
         DEBUG_WEBSOCKETS("[WS-Client] creating AsyncClient class failed!\n");
+        connectFailedCb();
+        asyncReconnect();
         return;
     }
 
+    _asyncConnecting = true;
+
     tcpclient->onDisconnect([](void *obj, AsyncClient* c) {
                 c->free();
                 delete c;
             });
 
     tcpclient->onConnect(std::bind([](WebSocketsClient * ws , AsyncClient * tcp) {
+                        ws->_asyncConnecting = false;
                         ws->_client.tcp = new AsyncTCPbuffer(tcp);
                         if(!ws->_client.tcp) {
                             DEBUG_WEBSOCKETS("[WS-Client] creating Network class failed!\n");
                             ws->connectFailedCb();
+                            tcp->close(true);
+                            ws->asyncReconnect();
                             return;
                         }
                         ws->connectedCb();
                     }, this, std::placeholders::_2));
 
     tcpclient->onError(std::bind([](WebSocketsClient * ws , AsyncClient * tcp) {
+                        ws->_asyncConnecting = false;
                         ws->connectFailedCb();
+                        // like the sync client, a failed connect is reported as disconnect
+                        ws->runCbEvent(WStype_DISCONNECTED, NULL, 0);
 
-                        // reconnect
-                        ws->asyncConnect();
+                        // reconnect from loop(), do not flood the server
+                        ws->asyncReconnect();
                     }, this, std::placeholders::_2));
 
     if(!tcpclient->connect(_host.c_str(), _port)) {
         connectFailedCb();
         delete tcpclient;
+        _asyncConnecting = false;
+        asyncReconnect();
+        runCbEvent(WStype_DISCONNECTED, NULL, 0);
     }
 
 }
 
+/**
+ * schedule a new connect, done by loop() after the reconnect delay
+ */
+void WebSocketsClient::asyncReconnect() {
+    _asyncReconnect = true;
+}
+
 #endif
@@ -32,6 +32,7 @@ class WebSocketsClient: private WebSockets {
 #ifdef __AVR__
         typedef void (*WebSocketClientEvent)(WStype_t type, uint8_t * payload, size_t length);
 #else
+        // payload points into the receive buffer and is only valid until the callback returns
         typedef std::function<void (WStype_t type, uint8_t * payload, size_t length)> WebSocketClientEvent;
 #endif
 
@@ -56,12 +57,7 @@ class WebSocketsClient: private WebSockets {
         void beginSocketIOSSL(String host, uint16_t port, String url = "/socket.io/?EIO=3", String protocol = "arduino");
 #endif
 
-#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
         void loop(void);
-#else
-        // Async interface not need a loop call
-        void loop(void) __attribute__ ((deprecated)) {}
-#endif
 
         void onEvent(WebSocketClientEvent cbEvent);
 
@@ -74,9 +70,17 @@ class WebSocketsClient: private WebSockets {
         bool sendBIN(uint8_t * payload, size_t length, bool headerToPayload = false);
         bool sendBIN(const uint8_t * payload, size_t length);
 
+        bool sendTXTStream(WSstreamProducer producer, size_t chunkSize = WEBSOCKETS_TX_ARENA_PAYLOAD);
+        bool sendBINStream(WSstreamProducer producer, size_t chunkSize = WEBSOCKETS_TX_ARENA_PAYLOAD);
+
         bool sendPing(uint8_t * payload = NULL, size_t length = 0);
         bool sendPing(String & payload);
 
+        bool sendPingProbe(void);
+        void setPingProbe(unsigned long interval);
+        uint32_t pingRTT(void);
+        unsigned long pingSilence(void);
+
         void disconnect(void);
 
         void setAuthorization(const char * user, const char * password);
@@ -85,6 +89,13 @@ class WebSocketsClient: private WebSockets {
         void setExtraHeaders(const char * extraHeaders = NULL);
 
         void setReconnectInterval(unsigned long time);
+        void setReconnectBackoff(unsigned long maxInterval, uint8_t jitter = 25);
+        void reconnectNow(void);
+
+        using WebSockets::rxPoolStats;
+
+        using WebSockets::setSendQueue;
+        WSqueueStats_t sendQueueStats(void);
 
     protected:
         String _host;
@@ -94,29 +105,66 @@ class WebSocketsClient: private WebSockets {
         String _fingerprint;
 #endif
         WSclient_t _client;
+        WSheader_t _header; ///< handshake state of _client, kept for good (extraHeaders, authorization)
 
         WebSocketClientEvent _cbEvent;
 
         unsigned long _lastConnectionFail;
         unsigned long _reconnectInterval;
+        unsigned long _reconnectMaxInterval;
+        unsigned long _reconnectDelay;
+        uint8_t _reconnectJitter;
+        uint8_t _reconnectFails;
+
+        char * _handshake;          ///< upgrade request, rendered once, key patched per connect
+        size_t _handshakeLength;
+        size_t _handshakeKeyPos;
+        char _key[WEBSOCKETS_KEY_LENGTH + 1];       ///< Sec-WebSocket-Key of the current connect
+        char _accept[WEBSOCKETS_ACCEPT_LENGTH + 1]; ///< expected Sec-WebSocket-Accept
+        bool _acceptValid;
+
+        unsigned long _pingInterval; ///< ms between ping probes, 0 = off
+        unsigned long _pingLast;     ///< millis() of the last probe
+        uint16_t _pingSeq;
+        uint8_t _pingProbe[sizeof(uint16_t) + sizeof(uint32_t)]; ///< payload of the last probe: sequence, micros()
+        uint32_t _pingRTT;           ///< us, probe answered by the last pong
+        unsigned long _pingPending;  ///< millis() of the oldest unanswered probe
+        bool _pingWaiting;           ///< a probe is not answered yet
+
+        char _headerLine[WEBSOCKETS_MAX_HEADER_LINE]; ///< header line parsed in place
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+        size_t _headerLineLength;
+#endif
 
         void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin);
 
         void clientDisconnect(WSclient_t * client);
         bool clientIsConnected(WSclient_t * client);
 
+        void handlePingProbe(void);
+
 #if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
         void handleClientData(void);
+        virtual WebSocketsTransport * createTransport(void);
 #endif
 
+        String buildHeader(WSclient_t * client, const char * key);
         void sendHeader(WSclient_t * client);
+        void handleHeader(WSclient_t * client, char * headerLine, size_t length);
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
         void handleHeader(WSclient_t * client, String * headerLine);
+#endif
+        void handshakeRelease(void);
 
         void connectedCb();
         void connectFailedCb();
 
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+        bool _asyncConnecting;
+        bool _asyncReconnect;
+
         void asyncConnect();
+        void asyncReconnect();
 #endif
 
         /**
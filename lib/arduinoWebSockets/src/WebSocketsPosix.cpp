@@ -0,0 +1,476 @@
+/**
+ * @file WebSocketsPosix.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "WebSockets.h"
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+// bits in WebSocketsPosixServer::_ready
+#define POSIX_READY_DATA (0x01)
+#define POSIX_READY_HUP (0x02)
+
+WebSocketsPosixClient::WebSocketsPosixClient(void) {
+    _fd = -1;
+    _peerClosed = false;
+    _sendBuffer = 0;
+    _timeout = 5000;
+    _server = NULL;
+}
+
+WebSocketsPosixClient::WebSocketsPosixClient(int fd, WebSocketsPosixServer * server) {
+    _fd = fd;
+    _peerClosed = false;
+    _sendBuffer = 0;
+    _timeout = 5000;
+    _server = server;
+    setup();
+}
+
+WebSocketsPosixClient::WebSocketsPosixClient(WebSocketsPosixClient && other) {
+    _fd = other._fd;
+    _peerClosed = other._peerClosed;
+    _sendBuffer = other._sendBuffer;
+    _timeout = other._timeout;
+    _server = other._server;
+    other._fd = -1;
+}
+
+WebSocketsPosixClient::~WebSocketsPosixClient(void) {
+    stop();
+}
+
+/**
+ * socket options for a new connection
+ */
+void WebSocketsPosixClient::setup(void) {
+    if(_fd < 0) {
+        return;
+    }
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+    setNoDelay(true);
+
+    socklen_t len = sizeof(_sendBuffer);
+    if(getsockopt(_fd, SOL_SOCKET, SO_SNDBUF, &_sendBuffer, &len) < 0) {
+        _sendBuffer = 0;
+    }
+}
+
+/**
+ * connect to host:port (IPv4), waits max setTimeout() ms
+ * @param host const char *
+ * @param port uint16_t
+ * @return 1 if connected
+ */
+int WebSocketsPosixClient::connect(const char * host, uint16_t port) {
+    stop();
+
+    struct addrinfo hints;
+    struct addrinfo * res = NULL;
+    memset(&hints, 0x00, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    char service[6];
+    snprintf(service, sizeof(service), "%u", port);
+
+    if(getaddrinfo(host, service, &hints, &res) != 0 || res == NULL) {
+        DEBUG_WEBSOCKETS("[WS-Posix] resolve %s failed\n", host);
+        return 0;
+    }
+
+    _fd = socket(res->ai_family, res->ai_socktype | SOCK_CLOEXEC, res->ai_protocol);
+    if(_fd < 0) {
+        freeaddrinfo(res);
+        return 0;
+    }
+    setup();
+
+    int ret = ::connect(_fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+
+    if(ret < 0 && errno == EINPROGRESS) {
+        struct pollfd pfd;
+        pfd.fd = _fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        if(::poll(&pfd, 1, _timeout) == 1) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            ret = (error == 0) ? 0 : -1;
+        }
+    }
+
+    if(ret < 0) {
+        DEBUG_WEBSOCKETS("[WS-Posix] connect %s:%u failed\n", host, port);
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * a closed connection stays "connected" while unread data is left, like the WiFiClient
+ * server side clients only ask the kernel after epoll reported an event
+ */
+uint8_t WebSocketsPosixClient::connected(void) {
+    if(_fd < 0) {
+        return 0;
+    }
+    if(_peerClosed) {
+        return (available() > 0);
+    }
+    if(_server && !(_server->isReady(_fd) & POSIX_READY_HUP)) {
+        return 1;
+    }
+
+    uint8_t c;
+    ssize_t ret = recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if(ret > 0) {
+        return 1;
+    }
+    if(ret == 0) {
+        _peerClosed = true;
+        return 0;
+    }
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+}
+
+int WebSocketsPosixClient::available(void) {
+    if(_fd < 0) {
+        return 0;
+    }
+    if(_server && !_server->isReady(_fd)) {
+        return 0;
+    }
+
+    int n = 0;
+    if(ioctl(_fd, FIONREAD, &n) < 0) {
+        return 0;
+    }
+    if(n == 0 && _server) {
+        // drained, level triggered epoll reports the next data
+        _server->setReady(_fd, _server->isReady(_fd) & ~POSIX_READY_DATA);
+    }
+    return n;
+}
+
+int WebSocketsPosixClient::read(void) {
+    uint8_t c;
+    if(read(&c, 1) != 1) {
+        return -1;
+    }
+    return c;
+}
+
+int WebSocketsPosixClient::read(uint8_t * buf, size_t size) {
+    if(_fd < 0) {
+        return -1;
+    }
+    ssize_t ret = recv(_fd, buf, size, MSG_DONTWAIT);
+    if(ret == 0 && size > 0) {
+        _peerClosed = true;
+    }
+    if(ret < 0) {
+        return -1;
+    }
+    return ret;
+}
+
+/**
+ * send what the kernel takes right now
+ * @return bytes accepted, 0 if the socket buffer is full or the connection is gone
+ */
+size_t WebSocketsPosixClient::write(const uint8_t * buf, size_t size) {
+    if(_fd < 0) {
+        return 0;
+    }
+    ssize_t ret = send(_fd, buf, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if(ret < 0) {
+        if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            // EPIPE / ECONNRESET, epoll may report it only in the next poll
+            _peerClosed = true;
+        }
+        return 0;
+    }
+    return ret;
+}
+
+size_t WebSocketsPosixClient::write(const char * str) {
+    return write((const uint8_t *) str, strlen(str));
+}
+
+/**
+ * free space in the socket send buffer
+ */
+int WebSocketsPosixClient::availableForWrite(void) {
+    if(_fd < 0) {
+        return 0;
+    }
+    int queued = 0;
+    if(_sendBuffer <= 0 || ioctl(_fd, SIOCOUTQ, &queued) < 0) {
+        // unknown, let send() decide
+        return WEBSOCKETS_TX_ARENA_PAYLOAD;
+    }
+    return (queued < _sendBuffer) ? (_sendBuffer - queued) : 0;
+}
+
+void WebSocketsPosixClient::flush(void) {
+    // send() hands the data to the kernel, nothing is buffered here
+}
+
+void WebSocketsPosixClient::stop(void) {
+    if(_fd < 0) {
+        return;
+    }
+    if(_server) {
+        _server->forget(_fd);
+    }
+    ::close(_fd);
+    _fd = -1;
+    _peerClosed = false;
+}
+
+void WebSocketsPosixClient::setNoDelay(bool nodelay) {
+    if(_fd < 0) {
+        return;
+    }
+    int flag = nodelay ? 1 : 0;
+    setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+/**
+ * @param timeout unsigned long  connect timeout in ms, reads and writes never block
+ */
+void WebSocketsPosixClient::setTimeout(unsigned long timeout) {
+    _timeout = timeout;
+}
+
+IPAddress WebSocketsPosixClient::remoteIP(void) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if(_fd < 0 || getpeername(_fd, (struct sockaddr *) &addr, &len) < 0 || addr.sin_family != AF_INET) {
+        return IPAddress(0, 0, 0, 0);
+    }
+    return IPAddress((uint32_t) addr.sin_addr.s_addr);
+}
+
+WebSocketsPosixServer::WebSocketsPosixServer(uint16_t port) {
+    _port = port;
+    _fd = -1;
+    _epoll = -1;
+    _pending = -1;
+    _ready = NULL;
+    _readySize = 0;
+}
+
+WebSocketsPosixServer::~WebSocketsPosixServer(void) {
+    close();
+    if(_ready) {
+        free(_ready);
+        _ready = NULL;
+        _readySize = 0;
+    }
+}
+
+/**
+ * listen on all interfaces
+ */
+void WebSocketsPosixServer::begin(void) {
+    close();
+
+    _fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(_fd < 0) {
+        DEBUG_WEBSOCKETS("[WS-Posix] socket failed (%d)\n", errno);
+        return;
+    }
+
+    int flag = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(_port);
+
+    if(bind(_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(_fd, WEBSOCKETS_POSIX_BACKLOG) < 0) {
+        DEBUG_WEBSOCKETS("[WS-Posix] listen on %u failed (%d)\n", _port, errno);
+        close();
+        return;
+    }
+
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    if(_epoll < 0) {
+        DEBUG_WEBSOCKETS("[WS-Posix] epoll_create1 failed (%d)\n", errno);
+        close();
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0x00, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = _fd;
+    epoll_ctl(_epoll, EPOLL_CTL_ADD, _fd, &ev);
+}
+
+/**
+ * stop listening, accepted clients stay open
+ */
+void WebSocketsPosixServer::close(void) {
+    if(_pending >= 0) {
+        ::close(_pending);
+        _pending = -1;
+    }
+    if(_epoll >= 0) {
+        ::close(_epoll);
+        _epoll = -1;
+    }
+    if(_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+/**
+ * collect the events of all sockets, called once per loop via hasClient()
+ */
+void WebSocketsPosixServer::poll(void) {
+    if(_epoll < 0) {
+        return;
+    }
+
+    struct epoll_event events[WEBSOCKETS_POSIX_EVENTS];
+    int count = epoll_wait(_epoll, events, WEBSOCKETS_POSIX_EVENTS, 0);
+
+    for(int i = 0; i < count; i++) {
+        int fd = events[i].data.fd;
+        if(fd == _fd) {
+            // one at a time, the rest waits in the backlog until available() took this one
+            if(_pending < 0) {
+                _pending = accept4(_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            }
+            continue;
+        }
+
+        uint8_t ready = isReady(fd);
+        if(events[i].events & EPOLLIN) {
+            ready |= POSIX_READY_DATA;
+        }
+        if(events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            ready |= POSIX_READY_HUP;
+        }
+        setReady(fd, ready);
+    }
+}
+
+bool WebSocketsPosixServer::hasClient(void) {
+    if(_pending < 0) {
+        poll();
+    }
+    return (_pending >= 0);
+}
+
+/**
+ * take the accepted connection, it is watched by epoll from now on
+ * @return WebSocketsPosixClient (not connected if there was none)
+ */
+WebSocketsPosixClient WebSocketsPosixServer::available(void) {
+    if(!hasClient()) {
+        return WebSocketsPosixClient();
+    }
+
+    int fd = _pending;
+    _pending = -1;
+
+    // make sure the ready table can hold the fd before epoll can report it
+    setReady(fd, 0);
+    if(_readySize <= (size_t) fd) {
+        ::close(fd);
+        return WebSocketsPosixClient();
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0x00, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.fd = fd;
+    if(epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        DEBUG_WEBSOCKETS("[WS-Posix] epoll_ctl failed (%d)\n", errno);
+        ::close(fd);
+        return WebSocketsPosixClient();
+    }
+
+    // the request may already be there
+    setReady(fd, POSIX_READY_DATA);
+    return WebSocketsPosixClient(fd, this);
+}
+
+uint8_t WebSocketsPosixServer::isReady(int fd) {
+    if(fd < 0 || (size_t) fd >= _readySize) {
+        return 0;
+    }
+    return _ready[fd];
+}
+
+void WebSocketsPosixServer::setReady(int fd, uint8_t ready) {
+    if(fd < 0) {
+        return;
+    }
+    if((size_t) fd >= _readySize) {
+        size_t size = ((fd / 64) + 1) * 64;
+        uint8_t * table = (uint8_t *) realloc(_ready, size);
+        if(!table) {
+            DEBUG_WEBSOCKETS("[WS-Posix] ready table realloc failed! to less memory\n");
+            return;
+        }
+        memset(&table[_readySize], 0x00, size - _readySize);
+        _ready = table;
+        _readySize = size;
+    }
+    _ready[fd] = ready;
+}
+
+/**
+ * the fd is closed, the kernel removes it from epoll
+ */
+void WebSocketsPosixServer::forget(int fd) {
+    if(fd >= 0 && (size_t) fd < _readySize) {
+        _ready[fd] = 0;
+    }
+}
+
+#endif
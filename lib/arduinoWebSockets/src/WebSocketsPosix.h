@@ -0,0 +1,123 @@
+/**
+ * @file WebSocketsPosix.h
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef WEBSOCKETSPOSIX_H_
+#define WEBSOCKETSPOSIX_H_
+
+// network type NETWORK_POSIX: kernel sockets on a Linux host, the server side uses epoll
+// the Arduino API (String, millis, delay, IPAddress) comes from host/ (see CMakeLists.txt)
+
+#include <stdint.h>
+#include <stddef.h>
+
+// max accepted connections waiting in the kernel
+#ifndef WEBSOCKETS_POSIX_BACKLOG
+#define WEBSOCKETS_POSIX_BACKLOG (128)
+#endif
+
+// max events taken from epoll per poll
+#ifndef WEBSOCKETS_POSIX_EVENTS
+#define WEBSOCKETS_POSIX_EVENTS (64)
+#endif
+
+class WebSocketsPosixServer;
+
+/**
+ * TCP connection on a non blocking socket, with the part of the WiFiClient interface the library uses
+ * write() returns what the kernel takes, the library queues or retries the rest
+ */
+class WebSocketsPosixClient {
+    public:
+        WebSocketsPosixClient(void);
+        WebSocketsPosixClient(WebSocketsPosixClient && other);
+        virtual ~WebSocketsPosixClient(void);
+
+        int connect(const char * host, uint16_t port);
+        uint8_t connected(void);
+
+        int available(void);
+        int read(void);
+        int read(uint8_t * buf, size_t size);
+
+        size_t write(const uint8_t * buf, size_t size);
+        size_t write(const char * str);
+        int availableForWrite(void);
+        void flush(void);
+
+        void stop(void);
+
+        void setNoDelay(bool nodelay);
+        void setTimeout(unsigned long timeout);
+
+        IPAddress remoteIP(void);
+
+    protected:
+        friend class WebSocketsPosixServer;
+
+        WebSocketsPosixClient(int fd, WebSocketsPosixServer * server);
+        WebSocketsPosixClient(const WebSocketsPosixClient &);
+        WebSocketsPosixClient & operator=(const WebSocketsPosixClient &);
+
+        void setup(void);
+
+        int _fd;
+        bool _peerClosed;
+        int _sendBuffer; ///< SO_SNDBUF of the socket
+        unsigned long _timeout;
+        WebSocketsPosixServer * _server; ///< reports the readiness (epoll), NULL for outgoing connections
+};
+
+/**
+ * listening socket, accepted sockets are watched with one epoll instance
+ * so idle clients cost no syscall in the loop
+ */
+class WebSocketsPosixServer {
+    public:
+        WebSocketsPosixServer(uint16_t port);
+        virtual ~WebSocketsPosixServer(void);
+
+        void begin(void);
+        void close(void);
+
+        bool hasClient(void);
+        WebSocketsPosixClient available(void);
+
+    protected:
+        friend class WebSocketsPosixClient;
+
+        void poll(void);
+        uint8_t isReady(int fd);
+        void setReady(int fd, uint8_t ready);
+        void forget(int fd);
+
+        uint16_t _port;
+        int _fd;      ///< listening socket
+        int _epoll;
+        int _pending; ///< accepted socket not taken by available() yet
+
+        uint8_t * _ready; ///< per fd: events reported by epoll since the last empty read
+        size_t _readySize;
+};
+
+#endif /* WEBSOCKETSPOSIX_H_ */
@@ -25,7 +25,7 @@
 #include "WebSockets.h"
 #include "WebSocketsServer.h"
 
-WebSocketsServer::WebSocketsServer(uint16_t port, String origin, String protocol) {
+WebSocketsServer::WebSocketsServer(uint16_t port, String origin, String protocol, uint8_t maxClients) {
     _port = port;
     _origin = origin;
     _protocol = protocol;
@@ -45,7 +45,34 @@ WebSocketsServer::WebSocketsServer(uint16_t port, String origin, String protocol
     _mandatoryHttpHeaders = NULL;
     _mandatoryHttpHeaderCount = 0;
 
-    memset(&_clients[0], 0x00, (sizeof(WSclient_t) * WEBSOCKETS_SERVER_CLIENT_MAX));
+    _txArena = NULL;
+    _txBroadcast = NULL;
+    _broadcasting = false;
+    _txQueueOnDemand = true;
+
+    // only the tables are reserved here, the client structs are allocated on the first connect of a slot
+    _clientsMax = maxClients;
+    _clients = (WSclient_t **) calloc(_clientsMax, sizeof(WSclient_t *));
+    _active = (uint8_t *) malloc(_clientsMax);
+    _headers = (WSheader_t **) malloc(_clientsMax * sizeof(WSheader_t *));
+    _headersFree = 0;
+    if(!_clients || !_active || !_headers) {
+        DEBUG_WEBSOCKETS("[WS-Server] to less memory for %d clients!\n", _clientsMax);
+        _clientsMax = 0;
+    }
+    _activeCount = 0;
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    _clientsIdle = false;
+
+    _poll = (uint8_t *) malloc(_clientsMax);
+    if(!_poll) {
+        DEBUG_WEBSOCKETS("[WS-Server] to less memory for %d clients!\n", _clientsMax);
+        _clientsMax = 0;
+    }
+    _pollStart = 0;
+    _pollBytes = WEBSOCKETS_SERVER_POLL_BYTES;
+    _pollTime = WEBSOCKETS_SERVER_POLL_TIME;
+#endif
 }
 
 
@@ -53,6 +80,45 @@ WebSocketsServer::~WebSocketsServer() {
     // disconnect all clients
 	close();
 
+    for(uint8_t i = 0; i < _clientsMax; i++) {
+        clientFree(i);
+    }
+
+    if(_clients) {
+        free(_clients);
+        _clients = NULL;
+    }
+
+    if(_active) {
+        free(_active);
+        _active = NULL;
+    }
+
+    if(_headers) {
+        while(_headersFree) {
+            delete _headers[--_headersFree];
+        }
+        free(_headers);
+        _headers = NULL;
+    }
+
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(_poll) {
+        free(_poll);
+        _poll = NULL;
+    }
+#endif
+
+    if(_txArena) {
+        free(_txArena);
+        _txArena = NULL;
+    }
+
+    if(_txBroadcast) {
+        free(_txBroadcast);
+        _txBroadcast = NULL;
+    }
+
     if (_mandatoryHttpHeaders)
         delete[] _mandatoryHttpHeaders;
 
@@ -63,35 +129,6 @@ WebSocketsServer::~WebSocketsServer() {
  * called to initialize the Websocket server
  */
 void WebSocketsServer::begin(void) {
-    WSclient_t * client;
-
-    // init client storage
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-
-        client->num = i;
-        client->status = WSC_NOT_CONNECTED;
-        client->tcp = NULL;
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
-        client->isSSL = false;
-        client->ssl = NULL;
-#endif
-        client->cUrl = "";
-        client->cCode = 0;
-        client->cKey = "";
-        client->cProtocol = "";
-        client->cVersion = 0;
-        client->cIsUpgrade = false;
-        client->cIsWebsocket = false;
-
-        client->base64Authorization = "";
-
-        client->cWsRXsize = 0;
-
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-        client->cHttpLine = "";
-#endif
-    }
 
 #ifdef ESP8266
     randomSeed(RANDOM_REG32);
@@ -113,7 +150,7 @@ void WebSocketsServer::close(void) {
 	_runnning = false;
 	 disconnect();
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
     _server->close();
 #elif (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     _server->end();
@@ -129,10 +166,22 @@ void WebSocketsServer::close(void) {
  */
 void WebSocketsServer::loop(void) {
 	if(_runnning) {
+		clientsRelease();
 		handleNewClients();
 		handleClientData();
 	}
 }
+
+/**
+ * limit the work for one client per loop() pass, the rest is handled in the next pass
+ * so one client sending a big or slow frame does not hold back the others
+ * @param maxBytes size_t  max bytes read from one client (0 = no limit)
+ * @param maxTime unsigned long  max us spend on one client, checked after each read (0 = no limit)
+ */
+void WebSocketsServer::setPollBudget(size_t maxBytes, unsigned long maxTime) {
+    _pollBytes = maxBytes;
+    _pollTime = maxTime;
+}
 #endif
 
 /**
@@ -176,13 +225,13 @@ void WebSocketsServer::onValidateHttpHeader(
  * @return true if ok
  */
 bool WebSocketsServer::sendTXT(uint8_t num, uint8_t * payload, size_t length, bool headerToPayload) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+    WSclient_t * client = clientByNum(num);
+    if(!client) {
         return false;
     }
     if(length == 0) {
         length = strlen((const char *) payload);
     }
-    WSclient_t * client = &_clients[num];
     if(clientIsConnected(client)) {
         return sendFrame(client, WSop_text, payload, length, false, true, headerToPayload);
     }
@@ -213,24 +262,10 @@ bool WebSocketsServer::sendTXT(uint8_t num, String & payload) {
  * @return true if ok
  */
 bool WebSocketsServer::broadcastTXT(uint8_t * payload, size_t length, bool headerToPayload) {
-    WSclient_t * client;
-    bool ret = true;
     if(length == 0) {
         length = strlen((const char *) payload);
     }
-
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-        if(clientIsConnected(client)) {
-            if(!sendFrame(client, WSop_text, payload, length, false, true, headerToPayload)) {
-                ret = false;
-            }
-        }
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
-        delay(0);
-#endif
-    }
-    return ret;
+    return broadcastFrame(WSop_text, payload, length, headerToPayload);
 }
 
 bool WebSocketsServer::broadcastTXT(const uint8_t * payload, size_t length) {
@@ -258,11 +293,8 @@ bool WebSocketsServer::broadcastTXT(String & payload) {
  * @return true if ok
  */
 bool WebSocketsServer::sendBIN(uint8_t num, uint8_t * payload, size_t length, bool headerToPayload) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
-        return false;
-    }
-    WSclient_t * client = &_clients[num];
-    if(clientIsConnected(client)) {
+    WSclient_t * client = clientByNum(num);
+    if(client && clientIsConnected(client)) {
         return sendFrame(client, WSop_binary, payload, length, false, true, headerToPayload);
     }
     return false;
@@ -272,6 +304,31 @@ bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t * payload, size_t leng
     return sendBIN(num, (uint8_t *) payload, length);
 }
 
+/**
+ * send a big message to client as fragments, chunk by chunk from the producer
+ * the chunk is in its own heap buffer (the transmit arena is shared by all clients),
+ * so the producer may send to other clients (not broadcast, that includes this client)
+ * @param num uint8_t client id
+ * @param producer WSstreamProducer  fills the next chunk, less then chunkSize ends the message
+ * @param chunkSize size_t  max payload per frame
+ * @return true if ok
+ */
+bool WebSocketsServer::sendTXTStream(uint8_t num, WSstreamProducer producer, size_t chunkSize) {
+    WSclient_t * client = clientByNum(num);
+    if(client && clientIsConnected(client)) {
+        return sendStream(client, WSop_text, producer, chunkSize, false, false);
+    }
+    return false;
+}
+
+bool WebSocketsServer::sendBINStream(uint8_t num, WSstreamProducer producer, size_t chunkSize) {
+    WSclient_t * client = clientByNum(num);
+    if(client && clientIsConnected(client)) {
+        return sendStream(client, WSop_binary, producer, chunkSize, false, false);
+    }
+    return false;
+}
+
 /**
  * send binary data to client all
  * @param payload uint8_t *
@@ -280,12 +337,73 @@ bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t * payload, size_t leng
  * @return true if ok
  */
 bool WebSocketsServer::broadcastBIN(uint8_t * payload, size_t length, bool headerToPayload) {
+    return broadcastFrame(WSop_binary, payload, length, headerToPayload);
+}
+
+bool WebSocketsServer::broadcastBIN(const uint8_t * payload, size_t length) {
+    return broadcastBIN((uint8_t *) payload, length);
+}
+
+
+/**
+ * send the same frame to all connected clients
+ * the frame is encoded once, every client gets the same bytes
+ * @param opcode WSopcode_t
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param headerToPayload bool  (see sendFrame for more details)
+ * @return true if ok
+ */
+bool WebSocketsServer::broadcastFrame(WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload) {
     WSclient_t * client;
     bool ret = true;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+
+    uint8_t header[WEBSOCKETS_MAX_HEADER_SIZE];
+    uint8_t headerSize = frameHeaderSize(length, false);
+    uint8_t * frame = NULL; ///< header and payload in one buffer
+
+    if(!payload) {
+        length = 0;
+    }
+
+    if(headerToPayload) {
+        frame = (payload + (WEBSOCKETS_MAX_HEADER_SIZE - headerSize));
+    }
+#ifdef WEBSOCKETS_USE_BIG_MEM
+    // a broadcast from a callback of the running one (disconnect) must not overwrite its frame
+    else if((length > 0) && (length <= WEBSOCKETS_TX_ARENA_PAYLOAD) && !_broadcasting) {
+        // copy once for all clients, so every client gets one TCP package
+        if(!_txBroadcast) {
+            _txBroadcast = (uint8_t *) malloc(WEBSOCKETS_MAX_HEADER_SIZE + WEBSOCKETS_TX_ARENA_PAYLOAD);
+        }
+        if(_txBroadcast) {
+            memcpy((_txBroadcast + WEBSOCKETS_MAX_HEADER_SIZE), payload, length);
+            frame = (_txBroadcast + (WEBSOCKETS_MAX_HEADER_SIZE - headerSize));
+        }
+    }
+#endif
+
+    createHeader((frame ? frame : &header[0]), opcode, length, false, NULL, true);
+
+    DEBUG_WEBSOCKETS("[WS-Server][broadcastFrame] opCode: %u length: %u one buffer: %u\n", opcode, length, (frame != NULL));
+
+    // the frame is not in the transmit arena, a disconnect callback may send to other clients
+    bool nested = _broadcasting;
+    _broadcasting = true;
+
+    // backwards, a client that gets disconnected is swapped with one already done
+    for(uint8_t i = _activeCount; i > 0; i--) {
+        client = _clients[_active[i - 1]];
         if(clientIsConnected(client)) {
-            if(!sendFrame(client, WSop_binary, payload, length, false, true, headerToPayload)) {
+            size_t sent = 0;
+            if(client->status == WSC_CONNECTED) {
+                if(frame) {
+                    sent = write(client, frame, (headerSize + length));
+                } else {
+                    sent = write(client, &header[0], headerSize, payload, length);
+                }
+            }
+            if(sent != (headerSize + length)) {
                 ret = false;
             }
         }
@@ -293,14 +411,10 @@ bool WebSocketsServer::broadcastBIN(uint8_t * payload, size_t length, bool heade
         delay(0);
 #endif
     }
+    _broadcasting = nested;
     return ret;
 }
 
-bool WebSocketsServer::broadcastBIN(const uint8_t * payload, size_t length) {
-    return broadcastBIN((uint8_t *) payload, length);
-}
-
-
 /**
  * sends a WS ping to Client
  * @param num uint8_t client id
@@ -309,11 +423,8 @@ bool WebSocketsServer::broadcastBIN(const uint8_t * payload, size_t length) {
  * @return true if ping is send out
  */
 bool WebSocketsServer::sendPing(uint8_t num, uint8_t * payload, size_t length) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
-        return false;
-    }
-    WSclient_t * client = &_clients[num];
-    if(clientIsConnected(client)) {
+    WSclient_t * client = clientByNum(num);
+    if(client && clientIsConnected(client)) {
         return sendFrame(client, WSop_ping, payload, length);
     }
     return false;
@@ -332,8 +443,8 @@ bool WebSocketsServer::sendPing(uint8_t num, String & payload) {
 bool WebSocketsServer::broadcastPing(uint8_t * payload, size_t length) {
     WSclient_t * client;
     bool ret = true;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    for(uint8_t i = _activeCount; i > 0; i--) {
+        client = _clients[_active[i - 1]];
         if(clientIsConnected(client)) {
             if(!sendFrame(client, WSop_ping, payload, length)) {
                 ret = false;
@@ -356,8 +467,8 @@ bool WebSocketsServer::broadcastPing(String & payload) {
  */
 void WebSocketsServer::disconnect(void) {
     WSclient_t * client;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    for(uint8_t i = _activeCount; i > 0; i--) {
+        client = _clients[_active[i - 1]];
         if(clientIsConnected(client)) {
             WebSockets::clientDisconnect(client, 1000);
         }
@@ -369,11 +480,8 @@ void WebSocketsServer::disconnect(void) {
  * @param num uint8_t client id
  */
 void WebSocketsServer::disconnect(uint8_t num) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
-        return;
-    }
-    WSclient_t * client = &_clients[num];
-    if(clientIsConnected(client)) {
+    WSclient_t * client = clientByNum(num);
+    if(client && clientIsConnected(client)) {
         WebSockets::clientDisconnect(client, 1000);
     }
 }
@@ -410,10 +518,10 @@ void WebSocketsServer::setAuthorization(const char * auth) {
 int WebSocketsServer::connectedClients(bool ping) {
     WSclient_t * client;
     int count = 0;
-	for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-		client = &_clients[i];
+	for(uint8_t i = _activeCount; i > 0; i--) {
+		client = _clients[_active[i - 1]];
 		if(client->status == WSC_CONNECTED) {
-			if(ping != true || sendPing(i)) {
+			if(ping != true || sendPing(client->num)) {
 				count++;
 			}
 		}
@@ -421,18 +529,31 @@ int WebSocketsServer::connectedClients(bool ping) {
     return count;
 }
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+/**
+ * get the send queue statistic of a client
+ * @param num uint8_t client id
+ * @return WSqueueStats_t
+ */
+WSqueueStats_t WebSocketsServer::sendQueueStats(uint8_t num) {
+    WSclient_t * client = clientByNum(num);
+    if(!client) {
+        WSqueueStats_t stats;
+        memset(&stats, 0x00, sizeof(stats));
+        return stats;
+    }
+    return txQueueStats(client);
+}
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
 /**
  * get an IP for a client
  * @param num uint8_t client id
  * @return IPAddress
  */
 IPAddress WebSocketsServer::remoteIP(uint8_t num) {
-    if(num < WEBSOCKETS_SERVER_CLIENT_MAX) {
-        WSclient_t * client = &_clients[num];
-        if(clientIsConnected(client)) {
-            return client->tcp->remoteIP();
-        }
+    WSclient_t * client = clientByNum(num);
+    if(client && clientIsConnected(client)) {
+        return client->tcp->remoteIP();
     }
 
     return IPAddress();
@@ -447,16 +568,40 @@ IPAddress WebSocketsServer::remoteIP(uint8_t num) {
  * handle new client connection
  * @param client
  */
-bool WebSocketsServer::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient) {
+bool WebSocketsServer::newClient(WEBSOCKETS_TRANSPORT_CLASS * TCPclient) {
     WSclient_t * client;
+
+    if(_activeCount >= _clientsMax) {
+        return false;
+    }
+
     // search free list entry for client
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    for(uint8_t i = 0; i < _clientsMax; i++) {
+        client = _clients[i];
 
-        // state is not connected or tcp connection is lost
-        if(!clientIsConnected(client)) {
+        // not allocated, state is not connected or tcp connection is lost
+        if(!client || !clientIsConnected(client)) {
+
+            WSheader_t * header = headerReserve();
+            if(!header) {
+                DEBUG_WEBSOCKETS("[WS-Server] to less memory for new client!\n");
+                return false;
+            }
+
+            if(!client) {
+                // value init, all members zero
+                client = new WSclient_t();
+                if(!client) {
+                    DEBUG_WEBSOCKETS("[WS-Server] to less memory for new client!\n");
+                    _headers[_headersFree++] = header;
+                    return false;
+                }
+                client->num = i;
+                _clients[i] = client;
+            }
 
             client->tcp = TCPclient;
+            client->header = header;
 
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
             client->isSSL = false;
@@ -467,8 +612,23 @@ bool WebSocketsServer::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient) {
             client->tcp->setTimeout(WEBSOCKETS_TCP_TIMEOUT);
 #endif
             client->status = WSC_HEADER;
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+            client->cWsRXtime = millis();
+            _active[_activeCount++] = client->num;
+
+#ifdef WEBSOCKETS_USE_BIG_MEM
+            // one frame is build at a time, all clients share one transmit arena
+            if(!_txArena) {
+                _txArena = (uint8_t *) malloc(WEBSOCKETS_MAX_HEADER_SIZE + WEBSOCKETS_TX_ARENA_PAYLOAD);
+            }
+            client->txArena = _txArena;
+#endif
+            // the send queue is reserved on the first backlog (_txQueueOnDemand)
+            txQueueClear(client);
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
+#ifndef NODEBUG_WEBSOCKETS
             IPAddress ip = client->tcp->remoteIP();
+#endif
             DEBUG_WEBSOCKETS("[WS-Server][%d] new client from %d.%d.%d.%d\n", client->num, ip[0], ip[1], ip[2], ip[3]);
 #else
             DEBUG_WEBSOCKETS("[WS-Server][%d] new client\n", client->num);
@@ -479,16 +639,18 @@ bool WebSocketsServer::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient) {
             client->tcp->onDisconnect(std::bind([](WebSocketsServer * server, AsyncTCPbuffer * obj, WSclient_t * client) -> bool {
                 DEBUG_WEBSOCKETS("[WS-Server][%d] Disconnect client\n", client->num);
 
-                AsyncTCPbuffer ** sl = &server->_clients[client->num].tcp;
-                if(*sl == obj) {
-                    client->status = WSC_NOT_CONNECTED;
-                    *sl = NULL;
+                // the struct stays allocated in async mode, but may already serve the next connection
+                if(client->tcp == obj) {
+                    client->tcp = NULL;
+                    if(client->status != WSC_NOT_CONNECTED) {
+                        server->clientDisconnect(client);
+                    }
                 }
                 return true;
             },  this, std::placeholders::_1, client));
 
 
-            client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsServer::handleHeader, this, client, &(client->cHttpLine)));
+            client->tcp->readStringUntil('\n', &(client->header->cHttpLine), std::bind(&WebSocketsServer::handleHeader, this, client, &(client->header->cHttpLine)));
 #endif
 
             return true;
@@ -498,6 +660,34 @@ bool WebSocketsServer::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient) {
     return false;
 }
 
+/**
+ * get the client struct of a connection number
+ * @param num uint8_t client id
+ * @return WSclient_t * or NULL if num is out of range or was never used
+ */
+WSclient_t * WebSocketsServer::clientByNum(uint8_t num) {
+    if(num >= _clientsMax) {
+        return NULL;
+    }
+    return _clients[num];
+}
+
+/**
+ * remove a client from the active list (swap with the last entry)
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSocketsServer::activeRemove(WSclient_t * client) {
+    for(uint8_t i = 0; i < _activeCount; i++) {
+        if(_active[i] == client->num) {
+            _active[i] = _active[--_activeCount];
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+            _clientsIdle = true;
+#endif
+            return;
+        }
+    }
+}
+
 /**
  *
  * @param client WSclient_t *  ptr to the client struct
@@ -518,9 +708,13 @@ void WebSocketsServer::messageReceived(WSclient_t * client, WSopcode_t opcode, u
         case WSop_continuation:
             type = fin ? WStype_FRAGMENT_FIN : WStype_FRAGMENT;
             break;
-        case WSop_close:
         case WSop_ping:
+            type = WStype_PING;
+            break;
         case WSop_pong:
+            type = WStype_PONG;
+            break;
+        case WSop_close:
         default:
             break;
     }
@@ -563,20 +757,16 @@ void WebSocketsServer::clientDisconnect(WSclient_t * client) {
         client->tcp = NULL;
     }
 
+    txQueueClear(client);
+    handleWebsocketReset(client);
+
     client->cUrl = "";
-    client->cKey = "";
-    client->cProtocol = "";
-    client->cVersion = 0;
-    client->cIsUpgrade = false;
-    client->cIsWebsocket = false;
+    headerRelease(client);
 
     client->cWsRXsize = 0;
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-    client->cHttpLine = "";
-#endif
-
     client->status = WSC_NOT_CONNECTED;
+    activeRemove(client);
 
     DEBUG_WEBSOCKETS("[WS-Server][%d] client disconnected.\n", client->num);
 
@@ -622,17 +812,13 @@ bool WebSocketsServer::clientIsConnected(WSclient_t * client) {
  */
 void WebSocketsServer::handleNewClients(void) {
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
     while(_server->hasClient()) {
 #endif
         bool ok = false;
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
         // store new connection
-        WEBSOCKETS_NETWORK_CLASS * tcpClient = new WEBSOCKETS_NETWORK_CLASS(_server->available());
-#else
-        WEBSOCKETS_NETWORK_CLASS * tcpClient = new WEBSOCKETS_NETWORK_CLASS(_server->available());
-#endif
+        WEBSOCKETS_TRANSPORT_CLASS * tcpClient = new WebSocketsTransportClient<WEBSOCKETS_NETWORK_CLASS>(_server->available());
 
         if(!tcpClient) {
             DEBUG_WEBSOCKETS("[WS-Client] creating Network class failed!");
@@ -643,16 +829,19 @@ void WebSocketsServer::handleNewClients(void) {
 
         if(!ok) {
             // no free space to handle client
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
+#ifndef NODEBUG_WEBSOCKETS
             IPAddress ip = tcpClient->remoteIP();
+#endif
             DEBUG_WEBSOCKETS("[WS-Server] no free space new client from %d.%d.%d.%d\n", ip[0], ip[1], ip[2], ip[3]);
 #else
             DEBUG_WEBSOCKETS("[WS-Server] no free space new client\n");
 #endif
             tcpClient->stop();
+            delete tcpClient;
         }
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
         delay(0);
     }
 #endif
@@ -662,30 +851,39 @@ void WebSocketsServer::handleNewClients(void) {
 
 /**
  * Handel incomming data from Client
+ * every client gets at most the poll budget, the first client changes on every pass (round robin)
  */
 void WebSocketsServer::handleClientData(void) {
 
     WSclient_t * client;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-        if(clientIsConnected(client)) {
-            int len = client->tcp->available();
-            if(len > 0) {
-                //DEBUG_WEBSOCKETS("[WS-Server][%d][handleClientData] len: %d\n", client->num, len);
-                switch(client->status) {
-                    case WSC_HEADER:
-                    {
-                        String headerLine = client->tcp->readStringUntil('\n');
-                        handleHeader(client, &headerLine);
-                    }
-                        break;
-                    case WSC_CONNECTED:
-                        WebSockets::handleWebsocket(client);
-                        break;
-                    default:
-                        WebSockets::clientDisconnect(client, 1002);
-                        break;
-                }
+    uint8_t count = _activeCount;
+
+    if(count == 0) {
+        return;
+    }
+
+    // work on a copy, clients can disconnect while the list is walked
+    if(_pollStart >= count) {
+        _pollStart = 0;
+    }
+    for(uint8_t i = 0; i < count; i++) {
+        _poll[i] = _active[((_pollStart + i) % count)];
+    }
+    _pollStart++;
+
+    for(uint8_t i = 0; i < count; i++) {
+        client = _clients[_poll[i]];
+        if(client && clientIsConnected(client)) {
+            if(client->status == WSC_CONNECTED) {
+                // reads what is there (up to the budget), keeps the frame state until the next call
+                WebSockets::handleWebsocket(client, _pollBytes, _pollTime);
+            } else if(client->status == WSC_HEADER) {
+                handleHeaderData(client);
+            } else if(client->tcp->available() > 0) {
+                WebSockets::clientDisconnect(client, 1002);
+            }
+            if(client->tcp) {
+                txFlush(client);
             }
         }
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
@@ -693,8 +891,117 @@ void WebSocketsServer::handleClientData(void) {
 #endif
     }
 }
+
+/**
+ * read the HTTP header without waiting for the end of the line
+ * the line is collected in cHttpLine over as many passes as needed
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSocketsServer::handleHeaderData(WSclient_t * client) {
+    size_t budget = _pollBytes;
+
+    while(client->tcp && client->status == WSC_HEADER && client->tcp->available() > 0) {
+        int c = client->tcp->read();
+        if(c < 0) {
+            break;
+        }
+        client->cWsRXtime = millis();
+
+        if(c == '\n') {
+            handleHeader(client, &client->header->cHttpLine);
+        } else if(client->header->cHttpLine.length() < WEBSOCKETS_MAX_HEADER_LINE) {
+            // longer lines are cut
+            client->header->cHttpLine += (char) c;
+        }
+
+        if(budget && --budget == 0) {
+            break;
+        }
+    }
+
+    // header stuck half way
+    if(client->tcp && client->status == WSC_HEADER && (millis() - client->cWsRXtime) > WEBSOCKETS_TCP_TIMEOUT) {
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeaderData] header TIMEOUT! %lu\n", client->num, (millis() - client->cWsRXtime));
+        clientDisconnect(client);
+    }
+}
+
+/**
+ * release the send queues of disconnected clients, the structs stay in their slot for the next connection
+ * called from loop, outside of any client handling that still holds the queue
+ */
+void WebSocketsServer::clientsRelease(void) {
+    if(!_clientsIdle) {
+        return;
+    }
+    _clientsIdle = false;
+
+    for(uint8_t i = 0; i < _clientsMax; i++) {
+        WSclient_t * client = _clients[i];
+        if(client && client->status == WSC_NOT_CONNECTED && !client->tcp) {
+            txQueueRelease(client);
+        }
+    }
+}
 #endif
 
+/**
+ * take a handshake state from the pool, allocated if the pool is empty
+ * @return WSheader_t * or NULL (out of memory)
+ */
+WSheader_t * WebSocketsServer::headerReserve(void) {
+    if(_headersFree) {
+        return _headers[--_headersFree];
+    }
+    // value init, all members zero
+    return new WSheader_t();
+}
+
+/**
+ * give the handshake state of a client back to the pool
+ * the Strings are emptied but keep their buffer for the next handshake
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSocketsServer::headerRelease(WSclient_t * client) {
+    WSheader_t * header = client->header;
+    if(!header) {
+        return;
+    }
+    client->header = NULL;
+
+    header->cCode = 0;
+    header->cIsUpgrade = false;
+    header->cIsWebsocket = false;
+    header->cKey = "";
+    header->cProtocol = "";
+    header->cExtensions = "";
+    header->cVersion = 0;
+    header->base64Authorization = "";
+    header->cHttpHeadersValid = false;
+    header->cMandatoryHeadersCount = 0;
+    header->cHttpLine = "";
+
+    // one header per client at most, the stack can not overflow
+    _headers[_headersFree++] = header;
+}
+
+/**
+ * free the struct of a client slot
+ * @param num uint8_t client id
+ */
+void WebSocketsServer::clientFree(uint8_t num) {
+    WSclient_t * client = _clients[num];
+    if(!client) {
+        return;
+    }
+    // the arena is the shared _txArena buffer
+    client->txArena = NULL;
+    txQueueRelease(client);
+    headerRelease(client);
+    delete client;
+    _clients[num] = NULL;
+}
+
 /*
  * returns an indicator whether the given named header exists in the configured _mandatoryHttpHeaders collection
  * @param headerName String ///< the name of the header being checked
@@ -729,8 +1036,8 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
 			client->cUrl = headerLine->substring(4, headerLine->indexOf(' ', 4));
 
 			//reset non-websocket http header validation state for this client
-			client->cHttpHeadersValid = true;
-			client->cMandatoryHeadersCount = 0;
+			client->header->cHttpHeadersValid = true;
+			client->header->cMandatoryHeadersCount = 0;
 
 		} else if(headerLine->indexOf(':')) {
 			String headerName = headerLine->substring(0, headerLine->indexOf(':'));
@@ -744,27 +1051,27 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
 			if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Connection"))) {
 				headerValue.toLowerCase();
 				if(headerValue.indexOf(WEBSOCKETS_STRING("upgrade")) >= 0) {
-					client->cIsUpgrade = true;
+					client->header->cIsUpgrade = true;
 				}
 			} else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Upgrade"))) {
 				if(headerValue.equalsIgnoreCase(WEBSOCKETS_STRING("websocket"))) {
-					client->cIsWebsocket = true;
+					client->header->cIsWebsocket = true;
 				}
 			} else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Version"))) {
-				client->cVersion = headerValue.toInt();
+				client->header->cVersion = headerValue.toInt();
 			} else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Key"))) {
-				client->cKey = headerValue;
-				client->cKey.trim(); // see rfc6455
+				client->header->cKey = headerValue;
+				client->header->cKey.trim(); // see rfc6455
 			} else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Protocol"))) {
-				client->cProtocol = headerValue;
+				client->header->cProtocol = headerValue;
 			} else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Extensions"))) {
-				client->cExtensions = headerValue;
+				client->header->cExtensions = headerValue;
 			} else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Authorization"))) {
-				client->base64Authorization = headerValue;
+				client->header->base64Authorization = headerValue;
 			} else {
-				client->cHttpHeadersValid &= execHttpHeaderValidation(headerName, headerValue);
+				client->header->cHttpHeadersValid &= execHttpHeaderValidation(headerName, headerValue);
 				if(_mandatoryHttpHeaderCount > 0 && hasMandatoryHeader(headerName)) {
-					client->cMandatoryHeadersCount++;
+					client->header->cMandatoryHeadersCount++;
 				}
 			}
 
@@ -774,38 +1081,38 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
 
         (*headerLine) = "";
 #if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-        client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsServer::handleHeader, this, client, &(client->cHttpLine)));
+        client->tcp->readStringUntil('\n', &(client->header->cHttpLine), std::bind(&WebSocketsServer::handleHeader, this, client, &(client->header->cHttpLine)));
 #endif
     } else {
 
         DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Header read fin.\n", client->num);
         DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cURL: %s\n", client->num, client->cUrl.c_str());
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsUpgrade: %d\n", client->num, client->cIsUpgrade);
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsWebsocket: %d\n", client->num, client->cIsWebsocket);
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cKey: %s\n", client->num, client->cKey.c_str());
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cProtocol: %s\n", client->num, client->cProtocol.c_str());
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cExtensions: %s\n", client->num, client->cExtensions.c_str());
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cVersion: %d\n", client->num, client->cVersion);
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - base64Authorization: %s\n", client->num, client->base64Authorization.c_str());
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cHttpHeadersValid: %d\n", client->num, client->cHttpHeadersValid);
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cMandatoryHeadersCount: %d\n", client->num, client->cMandatoryHeadersCount);
-
-        bool ok = (client->cIsUpgrade && client->cIsWebsocket);
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsUpgrade: %d\n", client->num, client->header->cIsUpgrade);
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsWebsocket: %d\n", client->num, client->header->cIsWebsocket);
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cKey: %s\n", client->num, client->header->cKey.c_str());
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cProtocol: %s\n", client->num, client->header->cProtocol.c_str());
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cExtensions: %s\n", client->num, client->header->cExtensions.c_str());
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cVersion: %d\n", client->num, client->header->cVersion);
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - base64Authorization: %s\n", client->num, client->header->base64Authorization.c_str());
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cHttpHeadersValid: %d\n", client->num, client->header->cHttpHeadersValid);
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cMandatoryHeadersCount: %d\n", client->num, client->header->cMandatoryHeadersCount);
+
+        bool ok = (client->header->cIsUpgrade && client->header->cIsWebsocket);
 
 		if(ok) {
 			if(client->cUrl.length() == 0) {
 				ok = false;
 			}
-			if(client->cKey.length() == 0) {
+			if(client->header->cKey.length() == 0) {
                 ok = false;
             }
-            if(client->cVersion != 13) {
+            if(client->header->cVersion != 13) {
                 ok = false;
             }
-            if(!client->cHttpHeadersValid) {
+            if(!client->header->cHttpHeadersValid) {
             	ok = false;
             }
-            if (client->cMandatoryHeadersCount != _mandatoryHttpHeaderCount) {
+            if (client->header->cMandatoryHeadersCount != _mandatoryHttpHeaderCount) {
             	ok = false;
             }
         }
@@ -813,7 +1120,7 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
         if(_base64Authorization.length() > 0) {
 			String auth = WEBSOCKETS_STRING("Basic ");
 			auth += _base64Authorization;
-			if(auth != client->base64Authorization) {
+			if(auth != client->header->base64Authorization) {
 				DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] HTTP Authorization failed!\n", client->num);
 				handleAuthorizationFailed(client);
 				return;
@@ -825,7 +1132,7 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
             DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Websocket connection incoming.\n", client->num);
 
             // generate Sec-WebSocket-Accept key
-            String sKey = acceptKey(client->cKey);
+            String sKey = acceptKey(client->header->cKey);
 
             DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - sKey: %s\n", client->num, sKey.c_str());
 
@@ -844,7 +1151,7 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
                 handshake +=_origin + NEW_LINE;
             }
 
-            if(client->cProtocol.length() > 0) {
+            if(client->header->cProtocol.length() > 0) {
             	handshake += WEBSOCKETS_STRING("Sec-WebSocket-Protocol: ");
             	handshake +=_protocol + NEW_LINE;
             }
@@ -857,6 +1164,7 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
             write(client, (uint8_t*)handshake.c_str(), handshake.length());
 
             headerDone(client);
+            headerRelease(client);
 
             // send ping
             WebSockets::sendFrame(client, WSop_ping);
@@ -31,6 +31,15 @@
 #define WEBSOCKETS_SERVER_CLIENT_MAX  (5)
 #endif
 
+// max work for one client per loop() pass, bytes and us (sync network types, see setPollBudget)
+#ifndef WEBSOCKETS_SERVER_POLL_BYTES
+#define WEBSOCKETS_SERVER_POLL_BYTES  (1460)
+#endif
+
+#ifndef WEBSOCKETS_SERVER_POLL_TIME
+#define WEBSOCKETS_SERVER_POLL_TIME  (2000)
+#endif
+
 
 
 
@@ -41,11 +50,12 @@ public:
         typedef void (*WebSocketServerEvent)(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
         typedef bool (*WebSocketServerHttpHeaderValFunc)(String headerName, String headerValue);
 #else
+        // payload points into the receive buffer and is only valid until the callback returns
         typedef std::function<void (uint8_t num, WStype_t type, uint8_t * payload, size_t length)> WebSocketServerEvent;
         typedef std::function<bool (String headerName, String headerValue)> WebSocketServerHttpHeaderValFunc;
 #endif
 
-        WebSocketsServer(uint16_t port, String origin = "", String protocol = "arduino");
+        WebSocketsServer(uint16_t port, String origin = "", String protocol = "arduino", uint8_t maxClients = WEBSOCKETS_SERVER_CLIENT_MAX);
         virtual ~WebSocketsServer(void);
 
         void begin(void);
@@ -53,6 +63,7 @@ public:
 
 #if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
         void loop(void);
+        void setPollBudget(size_t maxBytes, unsigned long maxTime);
 #else
         // Async interface not need a loop call
         void loop(void) __attribute__ ((deprecated)) {}
@@ -80,6 +91,9 @@ public:
         bool sendBIN(uint8_t num, uint8_t * payload, size_t length, bool headerToPayload = false);
         bool sendBIN(uint8_t num, const uint8_t * payload, size_t length);
 
+        bool sendTXTStream(uint8_t num, WSstreamProducer producer, size_t chunkSize = WEBSOCKETS_TX_ARENA_PAYLOAD);
+        bool sendBINStream(uint8_t num, WSstreamProducer producer, size_t chunkSize = WEBSOCKETS_TX_ARENA_PAYLOAD);
+
         bool broadcastBIN(uint8_t * payload, size_t length, bool headerToPayload = false);
         bool broadcastBIN(const uint8_t * payload, size_t length);
 
@@ -97,7 +111,12 @@ public:
 
         int connectedClients(bool ping = false);
 
-#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+        using WebSockets::rxPoolStats;
+
+        using WebSockets::setSendQueue;
+        WSqueueStats_t sendQueueStats(uint8_t num);
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
         IPAddress remoteIP(uint8_t num);
 #endif
 
@@ -111,14 +130,38 @@ protected:
 
         WEBSOCKETS_NETWORK_SERVER_CLASS * _server;
 
-        WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+        WSclient_t ** _clients;   ///< client table, indexed by num, a slot keeps its struct once allocated
+        uint8_t _clientsMax;      ///< size of the client table
+        WSheader_t ** _headers;   ///< handshake states not in use (stack), at most one per client
+        uint8_t _headersFree;
+        uint8_t * _active;        ///< num of all clients not in WSC_NOT_CONNECTED state (unordered)
+        uint8_t _activeCount;
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+        bool _clientsIdle;        ///< disconnected clients wait for clientsRelease
+
+        uint8_t * _poll;          ///< order of the clients in the current loop() pass
+        uint8_t _pollStart;       ///< round robin, first client of the next pass
+        size_t _pollBytes;        ///< max bytes read from one client per pass (0 = no limit)
+        unsigned long _pollTime;  ///< max us spend on one client per pass (0 = no limit)
+#endif
+
+        uint8_t * _txArena;     ///< transmit arena, shared by all clients (one frame is build at a time)
+        uint8_t * _txBroadcast; ///< frame buffer for broadcasts (encoded once for all clients), allocated on the first broadcast
+        bool _broadcasting;     ///< broadcastFrame is in its client loop, callbacks may send from there
 
         WebSocketServerEvent _cbEvent;
         WebSocketServerHttpHeaderValFunc _httpHeaderValidationFunc;
 
         bool _runnning;
 
-        bool newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient);
+        bool newClient(WEBSOCKETS_TRANSPORT_CLASS * TCPclient);
+        WSclient_t * clientByNum(uint8_t num);
+        void clientFree(uint8_t num);
+        WSheader_t * headerReserve(void);
+        void headerRelease(WSclient_t * client);
+        void activeRemove(WSclient_t * client);
+
+        bool broadcastFrame(WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload = false);
 
         void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin);
 
@@ -128,6 +171,8 @@ protected:
 #if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
         void handleNewClients(void);
         void handleClientData(void);
+        void handleHeaderData(WSclient_t * client);
+        void clientsRelease(void);
 #endif
 
         void handleHeader(WSclient_t * client, String * headerLine);
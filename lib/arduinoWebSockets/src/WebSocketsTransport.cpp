@@ -0,0 +1,162 @@
+/**
+ * @file WebSocketsTransport.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "WebSockets.h"
+
+#if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+
+WebSocketsLoopback::WebSocketsLoopback(size_t size) {
+    rxBytes = 0;
+    txBytes = 0;
+    _peer = NULL;
+    _head = 0;
+    _length = 0;
+    _size = size;
+    _buffer = (uint8_t *) malloc(_size);
+    if(!_buffer) {
+        DEBUG_WEBSOCKETS("[WS-Loopback] to less memory for %u byte buffer!\n", _size);
+        _size = 0;
+    }
+}
+
+WebSocketsLoopback::~WebSocketsLoopback(void) {
+    stop();
+    if(_buffer) {
+        free(_buffer);
+        _buffer = NULL;
+    }
+}
+
+/**
+ * connect two ends, what one writes the other reads
+ * @param peer WebSocketsLoopback *
+ */
+void WebSocketsLoopback::link(WebSocketsLoopback * peer) {
+    stop();
+    if(peer) {
+        peer->stop();
+        peer->_peer = this;
+    }
+    _peer = peer;
+}
+
+/**
+ * there is no address, "connected" if linked
+ */
+int WebSocketsLoopback::connect(const char * host, uint16_t port) {
+    return (_peer != NULL);
+}
+
+/**
+ * like a TCP connection the data left can still be read after the peer is gone
+ */
+uint8_t WebSocketsLoopback::connected(void) {
+    return (_peer != NULL || _length > 0);
+}
+
+int WebSocketsLoopback::available(void) {
+    return _length;
+}
+
+int WebSocketsLoopback::read(void) {
+    uint8_t c;
+    if(read(&c, 1) != 1) {
+        return -1;
+    }
+    return c;
+}
+
+int WebSocketsLoopback::read(uint8_t * buf, size_t size) {
+    if(size > _length) {
+        size = _length;
+    }
+    if(size == 0) {
+        return 0;
+    }
+
+    // max two parts, the ring may wrap
+    size_t first = _size - _head;
+    if(first > size) {
+        first = size;
+    }
+    memcpy(buf, &_buffer[_head], first);
+    memcpy(buf + first, &_buffer[0], size - first);
+
+    _head = (_head + size) % _size;
+    _length -= size;
+    rxBytes += size;
+    return size;
+}
+
+size_t WebSocketsLoopback::write(const uint8_t * buf, size_t size) {
+    if(!_peer) {
+        return 0;
+    }
+    size = _peer->push(buf, size);
+    txBytes += size;
+    return size;
+}
+
+int WebSocketsLoopback::availableForWrite(void) {
+    if(!_peer) {
+        return 0;
+    }
+    return (_peer->_size - _peer->_length);
+}
+
+/**
+ * unlink both ends, unread data stays readable
+ */
+void WebSocketsLoopback::stop(void) {
+    if(_peer) {
+        _peer->_peer = NULL;
+        _peer = NULL;
+    }
+}
+
+/**
+ * append to the ring buffer (called by the peer)
+ * @return bytes taken
+ */
+size_t WebSocketsLoopback::push(const uint8_t * buf, size_t size) {
+    if(size > (_size - _length)) {
+        size = (_size - _length);
+    }
+    if(size == 0) {
+        return 0;
+    }
+
+    size_t tail = (_head + _length) % _size;
+    size_t first = _size - tail;
+    if(first > size) {
+        first = size;
+    }
+    memcpy(&_buffer[tail], buf, first);
+    memcpy(&_buffer[0], buf + first, size - first);
+
+    _length += size;
+    return size;
+}
+
+#endif
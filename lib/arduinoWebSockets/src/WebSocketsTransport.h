@@ -0,0 +1,180 @@
+/**
+ * @file WebSocketsTransport.h
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef WEBSOCKETSTRANSPORT_H_
+#define WEBSOCKETSTRANSPORT_H_
+
+// size of one direction of a WebSocketsLoopback pipe
+#ifndef WEBSOCKETS_LOOPBACK_SIZE
+#define WEBSOCKETS_LOOPBACK_SIZE (2 * 1460)
+#endif
+
+/**
+ * byte stream under a websocket connection (all network types except NETWORK_ESP8266_ASYNC)
+ * the library only uses this interface, the network class is wrapped by WebSocketsTransportClient
+ * reads and writes must not block, write() returns what was taken
+ */
+class WebSocketsTransport {
+    public:
+        virtual ~WebSocketsTransport(void) {
+        }
+
+        virtual int connect(const char * host, uint16_t port) = 0;
+        virtual uint8_t connected(void) = 0;
+
+        virtual int available(void) = 0;
+        virtual int read(void) = 0;
+        virtual int read(uint8_t * buf, size_t size) = 0;
+
+        virtual size_t write(const uint8_t * buf, size_t size) = 0;
+        size_t write(const char * str) {
+            return write((const uint8_t *) str, strlen(str));
+        }
+        virtual int availableForWrite(void) = 0;
+        virtual void flush(void) {
+        }
+
+        virtual void stop(void) = 0;
+
+        virtual void setNoDelay(bool nodelay) {
+        }
+        virtual void setTimeout(unsigned long timeout) {
+        }
+        virtual IPAddress remoteIP(void) {
+            return IPAddress(0, 0, 0, 0);
+        }
+};
+
+/**
+ * WebSocketsTransport for a network client class (WiFiClient, EthernetClient, ...)
+ */
+template<class T>
+class WebSocketsTransportClient: public WebSocketsTransport {
+    public:
+        WebSocketsTransportClient(void) {
+        }
+
+        /**
+         * take over a connection, e.g. from WiFiServer::available()
+         * (static_cast instead of std::move, avr-libc has no <utility>)
+         */
+        WebSocketsTransportClient(T && tcp) :
+                _tcp(static_cast<T &&>(tcp)) {
+        }
+
+        T & client(void) {
+            return _tcp;
+        }
+
+        int connect(const char * host, uint16_t port) {
+            return _tcp.connect(host, port);
+        }
+        uint8_t connected(void) {
+            return _tcp.connected();
+        }
+
+        int available(void) {
+            return _tcp.available();
+        }
+        int read(void) {
+            return _tcp.read();
+        }
+        int read(uint8_t * buf, size_t size) {
+            return _tcp.read(buf, size);
+        }
+
+        size_t write(const uint8_t * buf, size_t size) {
+            return _tcp.write(buf, size);
+        }
+        int availableForWrite(void) {
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
+            return _tcp.availableForWrite();
+#else
+            // unknown, write() takes what fits
+            return WEBSOCKETS_TX_ARENA_PAYLOAD;
+#endif
+        }
+        void flush(void) {
+            _tcp.flush();
+        }
+
+        void stop(void) {
+            _tcp.stop();
+        }
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_POSIX)
+        void setNoDelay(bool nodelay) {
+            _tcp.setNoDelay(nodelay);
+        }
+        IPAddress remoteIP(void) {
+            return _tcp.remoteIP();
+        }
+#endif
+        void setTimeout(unsigned long timeout) {
+            _tcp.setTimeout(timeout);
+        }
+
+    protected:
+        T _tcp;
+};
+
+/**
+ * one end of an in-memory pipe, for tests and benchmarks of the whole framing path in one process
+ * the buffer is allocated in the constructor, reads and writes do not allocate
+ * write() takes what fits into the buffer of the peer, like a full TCP window
+ */
+class WebSocketsLoopback: public WebSocketsTransport {
+    public:
+        WebSocketsLoopback(size_t size = WEBSOCKETS_LOOPBACK_SIZE);
+        virtual ~WebSocketsLoopback(void);
+
+        void link(WebSocketsLoopback * peer);
+
+        int connect(const char * host, uint16_t port);
+        uint8_t connected(void);
+
+        int available(void);
+        int read(void);
+        int read(uint8_t * buf, size_t size);
+
+        size_t write(const uint8_t * buf, size_t size);
+        int availableForWrite(void);
+
+        void stop(void);
+
+        size_t rxBytes; ///< bytes read
+        size_t txBytes; ///< bytes written
+
+    protected:
+        size_t push(const uint8_t * buf, size_t size);
+
+        WebSocketsLoopback * _peer;
+
+        uint8_t * _buffer; ///< ring buffer, written by the peer
+        size_t _size;
+        size_t _head;
+        size_t _length;
+};
+
+#endif /* WEBSOCKETSTRANSPORT_H_ */
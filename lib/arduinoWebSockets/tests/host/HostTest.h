@@ -0,0 +1,58 @@
+/**
+ * @file HostTest.h
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOSTTEST_H_
+#define HOSTTEST_H_
+
+// checks for the host tests (one source file per test program)
+// a failed check is printed and counted, main() returns hostTestResult()
+
+#include <Arduino.h>
+
+static int hostTestFailures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if(!(cond)) { \
+            hostTestFailures++; \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while(0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        long long _a = (long long) (a); \
+        long long _b = (long long) (b); \
+        if(_a != _b) { \
+            hostTestFailures++; \
+            printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+        } \
+    } while(0)
+
+static inline int hostTestResult(void) {
+    printf("%s (%d failed checks)\n", hostTestFailures ? "FAILED" : "OK", hostTestFailures);
+    return hostTestFailures ? 1 : 0;
+}
+
+#endif /* HOSTTEST_H_ */
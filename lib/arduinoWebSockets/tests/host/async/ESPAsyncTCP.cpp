@@ -0,0 +1,317 @@
+/**
+ * @file ESPAsyncTCP.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "ESPAsyncTCP.h"
+#include "ESPAsyncTCPbuffer.h"
+
+AsyncClient * AsyncClient::peer = NULL;
+
+/**
+ * never destroyed, a global WebSocketsClient may still write from its destructor
+ */
+std::string & AsyncClient::hostSent(void) {
+    static std::string * sent = new std::string();
+    return *sent;
+}
+
+AsyncClient::AsyncClient(void * pcb) {
+    _state = HOST_IDLE;
+    _connectArg = NULL;
+    _disconnectArg = NULL;
+    _errorArg = NULL;
+    _dataArg = NULL;
+}
+
+AsyncClient::~AsyncClient(void) {
+    if(peer == this) {
+        peer = NULL;
+    }
+}
+
+/**
+ * nothing happens until the test calls hostAccept() or hostRefuse()
+ */
+bool AsyncClient::connect(const char * host, uint16_t port) {
+    if(_state != HOST_IDLE) {
+        return false;
+    }
+    _state = HOST_CONNECTING;
+    peer = this;
+    return true;
+}
+
+/**
+ * local close, the disconnect callback runs before this returns (and may delete the client)
+ */
+void AsyncClient::close(bool now) {
+    if(_state == HOST_IDLE) {
+        return;
+    }
+    disconnected();
+}
+
+void AsyncClient::stop(void) {
+    close(false);
+}
+
+int8_t AsyncClient::abort(void) {
+    close(true);
+    return 0;
+}
+
+bool AsyncClient::free(void) {
+    return _state == HOST_IDLE;
+}
+
+bool AsyncClient::connected(void) {
+    return _state == HOST_CONNECTED;
+}
+
+bool AsyncClient::connecting(void) {
+    return _state == HOST_CONNECTING;
+}
+
+void AsyncClient::onConnect(AcConnectHandler cb, void * arg) {
+    _connectCb = cb;
+    _connectArg = arg;
+}
+
+void AsyncClient::onDisconnect(AcConnectHandler cb, void * arg) {
+    _disconnectCb = cb;
+    _disconnectArg = arg;
+}
+
+void AsyncClient::onError(AcErrorHandler cb, void * arg) {
+    _errorCb = cb;
+    _errorArg = arg;
+}
+
+void AsyncClient::onData(AcDataHandler cb, void * arg) {
+    _dataCb = cb;
+    _dataArg = arg;
+}
+
+size_t AsyncClient::space(void) {
+    return connected() ? 0xFFFF : 0;
+}
+
+size_t AsyncClient::write(const char * data, size_t size) {
+    if(!connected()) {
+        return 0;
+    }
+    hostSent().append(data, size);
+    return size;
+}
+
+void AsyncClient::hostAccept(void) {
+    if(_state != HOST_CONNECTING) {
+        return;
+    }
+    _state = HOST_CONNECTED;
+    if(_connectCb) {
+        _connectCb(_connectArg, this);
+    }
+}
+
+/**
+ * connect failed: error, then disconnect (like ESPAsyncTCP)
+ */
+void AsyncClient::hostRefuse(void) {
+    if(_state != HOST_CONNECTING) {
+        return;
+    }
+    if(_errorCb) {
+        _errorCb(_errorArg, this, -14);
+    }
+    disconnected();
+}
+
+void AsyncClient::hostReceive(const uint8_t * data, size_t size) {
+    if(connected() && _dataCb) {
+        _dataCb(_dataArg, this, (void *) data, size);
+    }
+}
+
+void AsyncClient::hostClose(void) {
+    close(true);
+}
+
+void AsyncClient::disconnected(void) {
+    _state = HOST_IDLE;
+    if(_disconnectCb) {
+        // copy, the callback may delete this
+        AcConnectHandler cb = _disconnectCb;
+        cb(_disconnectArg, this);
+    }
+}
+
+//#################################################################################
+
+AsyncTCPbuffer::AsyncTCPbuffer(AsyncClient * client) {
+    _client = client;
+    _busy = false;
+    _alive = NULL;
+    _mode = RX_NONE;
+    _terminator = 0;
+    _string = NULL;
+    _buffer = NULL;
+    _length = 0;
+    _pos = 0;
+
+    _client->onData([](void * obj, AsyncClient * c, void * data, size_t length) {
+        AsyncTCPbuffer * b = (AsyncTCPbuffer *) obj;
+        b->_rx.append((const char *) data, length);
+        b->handleRx();
+    }, this);
+
+    _client->onDisconnect([](void * obj, AsyncClient * c) {
+        AsyncTCPbuffer * b = (AsyncTCPbuffer *) obj;
+        b->_client = NULL;
+        bool del = true;
+        if(b->_disconnect) {
+            del = b->_disconnect(b);
+        }
+        delete c;
+        if(del) {
+            delete b;
+        }
+    }, this);
+}
+
+AsyncTCPbuffer::~AsyncTCPbuffer(void) {
+    if(_alive) {
+        *_alive = false;
+    }
+    if(_client) {
+        _client->onDisconnect(NULL);
+        _client->onData(NULL);
+        delete _client;
+    }
+}
+
+size_t AsyncTCPbuffer::write(const uint8_t * data, size_t size) {
+    if(!connected()) {
+        return 0;
+    }
+    return _client->write((const char *) data, size);
+}
+
+void AsyncTCPbuffer::noCallback(void) {
+    _mode = RX_NONE;
+    _done = NULL;
+}
+
+void AsyncTCPbuffer::readStringUntil(char terminator, String * str, AsyncTCPbufferDoneCb done) {
+    _mode = RX_STRING;
+    _terminator = terminator;
+    _string = str;
+    _done = done;
+    handleRx();
+}
+
+void AsyncTCPbuffer::readBytes(uint8_t * buffer, size_t length, AsyncTCPbufferDoneCb done) {
+    _mode = RX_BYTES;
+    _buffer = buffer;
+    _length = length;
+    _pos = 0;
+    _done = done;
+    handleRx();
+}
+
+void AsyncTCPbuffer::onDisconnect(AsyncTCPbufferDisconnectCb cb) {
+    _disconnect = cb;
+}
+
+IPAddress AsyncTCPbuffer::remoteIP(void) {
+    return _client ? _client->remoteIP() : IPAddress();
+}
+
+bool AsyncTCPbuffer::connected(void) {
+    return _client && _client->connected();
+}
+
+/**
+ * close the connection, the disconnect of the AsyncClient deletes this
+ */
+void AsyncTCPbuffer::stop(void) {
+    _mode = RX_NONE;
+    _done = NULL;
+    if(_client) {
+        _client->close(true);
+    }
+}
+
+void AsyncTCPbuffer::close(void) {
+    stop();
+}
+
+/**
+ * hand the buffered data to the pending read, the done callbacks usually start the next read
+ * (runs only once at a time, a read started from a callback continues in the loop)
+ */
+void AsyncTCPbuffer::handleRx(void) {
+    if(_busy) {
+        return;
+    }
+    _busy = true;
+    bool alive = true;
+    _alive = &alive;
+
+    while(alive && _mode != RX_NONE && !_rx.empty()) {
+        if(_mode == RX_STRING) {
+            size_t end = _rx.find(_terminator);
+            size_t n = (end == std::string::npos) ? _rx.length() : end;
+            _string->concat(_rx.data(), n);
+            _rx.erase(0, (end == std::string::npos) ? n : n + 1);
+            if(end != std::string::npos) {
+                done(_string);
+            }
+        } else {
+            size_t n = _length - _pos;
+            if(n > _rx.length()) {
+                n = _rx.length();
+            }
+            memcpy(_buffer + _pos, _rx.data(), n);
+            _rx.erase(0, n);
+            _pos += n;
+            if(_pos == _length) {
+                done(_buffer);
+            }
+        }
+    }
+
+    if(alive) {
+        _alive = NULL;
+        _busy = false;
+    }
+}
+
+void AsyncTCPbuffer::done(void * ret) {
+    AsyncTCPbufferDoneCb cb = _done;
+    _mode = RX_NONE;
+    _done = NULL;
+    if(cb) {
+        cb(true, ret);
+    }
+}
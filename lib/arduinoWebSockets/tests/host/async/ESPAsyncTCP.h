@@ -0,0 +1,98 @@
+/**
+ * @file ESPAsyncTCP.h
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_ESPASYNCTCP_H_
+#define HOST_ESPASYNCTCP_H_
+
+// in-memory fake of the ESPAsyncTCP client for the host tests of NETWORK_ESP8266_ASYNC
+// (only what the library uses), the test plays the remote side with the host* functions,
+// all callbacks run synchronously from there, like from the lwIP callbacks on the ESP
+
+#include <Arduino.h>
+
+#include <string>
+
+class AsyncClient;
+
+typedef std::function<void(void *, AsyncClient *)> AcConnectHandler;
+typedef std::function<void(void *, AsyncClient *, int8_t)> AcErrorHandler;
+typedef std::function<void(void *, AsyncClient *, void *, size_t)> AcDataHandler;
+
+class AsyncClient {
+    public:
+        AsyncClient(void * pcb = NULL);
+        ~AsyncClient(void);
+
+        bool connect(const char * host, uint16_t port);
+        void close(bool now = false);
+        void stop(void);
+        int8_t abort(void);
+        bool free(void);
+
+        bool connected(void);
+        bool connecting(void);
+        void setNoDelay(bool nodelay) {
+        }
+        IPAddress remoteIP(void) {
+            return IPAddress(127, 0, 0, 1);
+        }
+
+        void onConnect(AcConnectHandler cb, void * arg = NULL);
+        void onDisconnect(AcConnectHandler cb, void * arg = NULL);
+        void onError(AcErrorHandler cb, void * arg = NULL);
+        void onData(AcDataHandler cb, void * arg = NULL);
+
+        size_t space(void);
+        size_t write(const char * data, size_t size);
+
+        // remote side (the test)
+
+        static AsyncClient * peer;    ///< the client of the last connect(), NULL when deleted
+        static std::string & hostSent(void); ///< written by the local side, kept when the client is deleted
+
+        void hostAccept(void);
+        void hostRefuse(void);
+        void hostReceive(const uint8_t * data, size_t size);
+        void hostClose(void);
+
+    protected:
+        void disconnected(void);
+
+        enum {
+            HOST_IDLE,
+            HOST_CONNECTING,
+            HOST_CONNECTED
+        } _state;
+
+        AcConnectHandler _connectCb;
+        void * _connectArg;
+        AcConnectHandler _disconnectCb;
+        void * _disconnectArg;
+        AcErrorHandler _errorCb;
+        void * _errorArg;
+        AcDataHandler _dataCb;
+        void * _dataArg;
+};
+
+#endif /* HOST_ESPASYNCTCP_H_ */
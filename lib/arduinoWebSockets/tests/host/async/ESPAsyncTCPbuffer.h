@@ -0,0 +1,88 @@
+/**
+ * @file ESPAsyncTCPbuffer.h
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_ESPASYNCTCPBUFFER_H_
+#define HOST_ESPASYNCTCPBUFFER_H_
+
+// fake of the ESPAsyncTCPbuffer on top of the fake AsyncClient (see ESPAsyncTCP.h)
+// the received data is buffered until a readStringUntil / readBytes takes it,
+// the disconnect of the AsyncClient deletes it, unless the onDisconnect callback returns false
+
+#include "ESPAsyncTCP.h"
+
+class AsyncTCPbuffer {
+    public:
+        typedef std::function<size_t(uint8_t * payload, size_t length)> AsyncTCPbufferDataCb;
+        typedef std::function<void(bool ok, void * ret)> AsyncTCPbufferDoneCb;
+        typedef std::function<bool(AsyncTCPbuffer * obj)> AsyncTCPbufferDisconnectCb;
+
+        AsyncTCPbuffer(AsyncClient * client);
+        virtual ~AsyncTCPbuffer(void);
+
+        size_t write(const uint8_t * data, size_t size);
+        size_t write(const char * data, size_t size) {
+            return write((const uint8_t *) data, size);
+        }
+        void flush(void) {
+        }
+
+        void noCallback(void);
+        void readStringUntil(char terminator, String * str, AsyncTCPbufferDoneCb done);
+        void readBytes(uint8_t * buffer, size_t length, AsyncTCPbufferDoneCb done);
+        void readBytes(char * buffer, size_t length, AsyncTCPbufferDoneCb done) {
+            readBytes((uint8_t *) buffer, length, done);
+        }
+
+        void onDisconnect(AsyncTCPbufferDisconnectCb cb);
+
+        IPAddress remoteIP(void);
+        bool connected(void);
+        void stop(void);
+        void close(void);
+
+    protected:
+        void handleRx(void);
+        void done(void * ret);
+
+        AsyncClient * _client;
+        std::string _rx;
+        bool _busy;
+        bool * _alive;
+
+        enum {
+            RX_NONE,
+            RX_STRING,
+            RX_BYTES
+        } _mode;
+        char _terminator;
+        String * _string;
+        uint8_t * _buffer;
+        size_t _length;
+        size_t _pos;
+
+        AsyncTCPbufferDoneCb _done;
+        AsyncTCPbufferDisconnectCb _disconnect;
+};
+
+#endif /* HOST_ESPASYNCTCPBUFFER_H_ */
@@ -0,0 +1,187 @@
+/**
+ * @file test_broadcast.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// broadcast while a client is gone: the broadcast loop finds the lost connection of c first,
+// the disconnect callback sends to a (transmit arena) and broadcasts (nested),
+// a and b must still get the broadcast frame unchanged
+
+#include "HostTest.h"
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define PIPE_SIZE 2920
+
+class LoopServer: public WebSocketsServer {
+    public:
+        LoopServer() :
+                WebSocketsServer(81, "", "arduino", 3) {
+        }
+
+        bool attach(WebSocketsLoopback * pipe) {
+            return newClient(pipe);
+        }
+
+        // loop() without accepting
+        void run() {
+            clientsRelease();
+            handleClientData();
+        }
+};
+
+LoopServer server;
+WebSocketsLoopback * lastEnd = NULL;
+
+class LoopClient: public WebSocketsClient {
+    protected:
+        WebSocketsTransport * createTransport() {
+            WebSocketsLoopback * end = new WebSocketsLoopback(PIPE_SIZE);
+            WebSocketsLoopback * serverEnd = new WebSocketsLoopback(PIPE_SIZE);
+            end->link(serverEnd);
+            if(!server.attach(serverEnd)) {
+                delete serverEnd;
+            }
+            lastEnd = end;
+            return end;
+        }
+};
+
+LoopClient a;
+LoopClient b;
+LoopClient c;
+
+const char * BROADCAST = "broadcast to every client, encoded once";
+const char * OTHER = "from the disconnect callback, to client 0";
+const char * NESTED = "nested";
+
+struct Received {
+    bool connected;
+    uint32_t broadcasts;
+    uint32_t others;
+    uint32_t nested;
+    uint32_t bad;
+};
+
+Received receivedA;
+Received receivedB;
+uint32_t disconnects = 0;
+
+void text(Received & r, WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_CONNECTED) {
+        r.connected = true;
+    }
+    if(type != WStype_TEXT) {
+        return;
+    }
+    if(length == strlen(BROADCAST) && memcmp(data, BROADCAST, length) == 0) {
+        r.broadcasts++;
+    } else if(length == strlen(OTHER) && memcmp(data, OTHER, length) == 0) {
+        r.others++;
+    } else if(length == strlen(NESTED) && memcmp(data, NESTED, length) == 0) {
+        r.nested++;
+    } else {
+        r.bad++;
+    }
+}
+
+void eventA(WStype_t type, uint8_t * data, size_t length) {
+    text(receivedA, type, data, length);
+}
+
+void eventB(WStype_t type, uint8_t * data, size_t length) {
+    text(receivedB, type, data, length);
+}
+
+bool connectedC = false;
+
+void eventC(WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_CONNECTED) {
+        connectedC = true;
+    }
+}
+
+void serverEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_DISCONNECTED && num == 2) {
+        disconnects++;
+        server.sendTXT(0, OTHER);
+        server.broadcastTXT(NESTED);
+    }
+}
+
+void run(void) {
+    for(uint16_t i = 0; i < 100; i++) {
+        server.run();
+        a.loop();
+        b.loop();
+    }
+}
+
+int main(void) {
+    server.onEvent(serverEvent);
+    a.onEvent(eventA);
+    b.onEvent(eventB);
+    c.onEvent(eventC);
+
+    a.begin("loopback", 81, "/");
+    for(uint16_t i = 0; i < 100 && !receivedA.connected; i++) {
+        a.loop();
+        server.run();
+    }
+    b.begin("loopback", 81, "/");
+    for(uint16_t i = 0; i < 100 && !receivedB.connected; i++) {
+        b.loop();
+        server.run();
+    }
+    c.begin("loopback", 81, "/");
+    for(uint16_t i = 0; i < 100 && !connectedC; i++) {
+        c.loop();
+        server.run();
+    }
+    CHECK(receivedA.connected);
+    CHECK(receivedB.connected);
+    CHECK(connectedC);
+    for(uint16_t i = 0; i < 100; i++) {
+        server.run();
+        a.loop();
+        b.loop();
+        c.loop();
+    }
+    CHECK_EQ(server.connectedClients(), 3);
+
+    // c is gone, the server only notices in the broadcast loop
+    lastEnd->stop();
+    server.broadcastTXT(BROADCAST);
+    CHECK_EQ(disconnects, 1);
+    run();
+
+    CHECK_EQ(receivedA.broadcasts, 1);
+    CHECK_EQ(receivedA.others, 1);
+    CHECK_EQ(receivedA.nested, 1);
+    CHECK_EQ(receivedA.bad, 0);
+    CHECK_EQ(receivedB.broadcasts, 1);
+    CHECK_EQ(receivedB.nested, 1);
+    CHECK_EQ(receivedB.bad, 0);
+
+    return hostTestResult();
+}
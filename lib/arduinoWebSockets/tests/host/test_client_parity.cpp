@@ -0,0 +1,463 @@
+/**
+ * @file test_client_parity.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// the sync client (over a WebSocketsLoopback) and the async client (NETWORK_ESP8266_ASYNC,
+// over the fake ESPAsyncTCP in async/) are built from this one file (test_client_parity and
+// test_client_parity_async) and have to write the same transcript:
+// refused connect and reconnect interval, handshake, frames both ways (fragments, ping / pong),
+// close from the remote, reconnect, connection lost, local disconnect
+// the remote side is played by the test, on the byte level
+
+#include "HostTest.h"
+
+#include <WebSocketsClient.h>
+
+#include <string>
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+#include <ESPAsyncTCP.h>
+#endif
+
+#define PIPE_SIZE (32 * 1024)
+#define SPLIT_MAX 9
+#define RUN_LOOPS 20
+#define RECONNECT_INTERVAL 500
+
+std::string transcript;
+
+void note(const char * format, ...) __attribute__((format(printf, 1, 2)));
+void note(const char * format, ...) {
+    char line[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    transcript += line;
+    transcript += "\n";
+}
+
+// FNV-1a, payloads are noted as length and hash
+uint32_t hash(const uint8_t * data, size_t length) {
+    uint32_t h = 2166136261u;
+    for(size_t i = 0; i < length; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+//#################################################################################
+// remote side: handshake and frames, on the bytes the client wrote
+
+class KeyAccess: public WebSockets {
+    public:
+        using WebSockets::acceptKey;
+};
+
+std::string wire;       ///< received from the client, not parsed yet
+bool handshake = false; ///< done on this connection
+uint8_t connects = 0;
+
+void remoteWrite(const std::string & data);
+
+std::string frame(uint8_t opcode, bool fin, const uint8_t * payload, size_t length) {
+    std::string out;
+    out += (char) ((fin ? 0x80 : 0x00) | opcode);
+    if(length < 126) {
+        out += (char) length;
+    } else {
+        out += (char) 126;
+        out += (char) (length >> 8);
+        out += (char) (length & 0xFF);
+    }
+    out.append((const char *) payload, length);
+    return out;
+}
+
+std::string frame(uint8_t opcode, bool fin, const char * payload) {
+    return frame(opcode, fin, (const uint8_t *) payload, strlen(payload));
+}
+
+const char * opcodeName(uint8_t opcode) {
+    switch(opcode) {
+        case WSop_continuation:
+            return "CONTINUATION";
+        case WSop_text:
+            return "TEXT";
+        case WSop_binary:
+            return "BIN";
+        case WSop_close:
+            return "CLOSE";
+        case WSop_ping:
+            return "PING";
+        case WSop_pong:
+            return "PONG";
+        default:
+            return "?";
+    }
+}
+
+void remoteHandshake(void) {
+    size_t end = wire.find("\r\n\r\n");
+    if(end == std::string::npos) {
+        return;
+    }
+    std::string request = wire.substr(0, end);
+    wire.erase(0, end + 4);
+
+    note("remote: %s", request.substr(0, request.find("\r\n")).c_str());
+    size_t key = request.find("Sec-WebSocket-Key: ");
+    if(key == std::string::npos) {
+        note("remote: no key");
+        return;
+    }
+    char accept[WEBSOCKETS_ACCEPT_LENGTH + 1];
+    KeyAccess::acceptKey(request.c_str() + key + 19, accept);
+
+    handshake = true;
+    std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Protocol: arduino\r\n"
+            "Sec-WebSocket-Accept: ";
+    response += accept;
+    response += "\r\n\r\n";
+    remoteWrite(response);
+}
+
+/**
+ * note every complete frame from the client, answer pings
+ */
+void remoteParse(void) {
+    if(!handshake) {
+        remoteHandshake();
+    }
+    while(handshake && wire.length() >= 2) {
+        const uint8_t * p = (const uint8_t *) wire.data();
+        uint8_t opcode = p[0] & 0x0F;
+        bool fin = p[0] & 0x80;
+        bool masked = p[1] & 0x80;
+        size_t length = p[1] & 0x7F;
+        size_t header = 2;
+        if(length == 126) {
+            if(wire.length() < 4) {
+                return;
+            }
+            length = (p[2] << 8) | p[3];
+            header = 4;
+        } else if(length == 127) {
+            note("remote: 64 bit length");
+            wire.clear();
+            return;
+        }
+        if(wire.length() < header + (masked ? 4 : 0) + length) {
+            return;
+        }
+        uint8_t mask[4] = { 0, 0, 0, 0 };
+        if(masked) {
+            memcpy(mask, p + header, 4);
+            header += 4;
+        }
+        std::string payload = wire.substr(header, length);
+        wire.erase(0, header + length);
+        for(size_t i = 0; i < length; i++) {
+            payload[i] ^= mask[i % 4];
+        }
+        const uint8_t * data = (const uint8_t *) payload.data();
+
+        if(opcode == WSop_close && length >= 2) {
+            note("remote: %s%s %u", opcodeName(opcode), masked ? "" : " unmasked", (data[0] << 8) | data[1]);
+        } else {
+            note("remote: %s%s%s %u %08x", opcodeName(opcode), fin ? "" : " (more)", masked ? "" : " unmasked", (unsigned) length, hash(data, length));
+        }
+        if(opcode == WSop_ping) {
+            remoteWrite(frame(WSop_pong, true, data, length));
+        }
+    }
+}
+
+/**
+ * new connection of the client, the bytes of the old one are parsed first
+ */
+void remoteConnect(void) {
+    remoteParse();
+    wire.clear();
+    handshake = false;
+    connects++;
+    note("remote: connect %u", connects);
+}
+
+bool refuse = false;
+
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+
+// AsyncClient: connects wait for remotePoll(), data is delivered in random pieces right away
+
+void remotePoll(void) {
+    if(AsyncClient::peer && AsyncClient::peer->connecting()) {
+        remoteConnect();
+        if(refuse) {
+            AsyncClient::peer->hostRefuse();
+        } else {
+            AsyncClient::peer->hostAccept();
+        }
+    }
+    wire += AsyncClient::hostSent();
+    AsyncClient::hostSent().clear();
+}
+
+void remoteWrite(const std::string & data) {
+    size_t pos = 0;
+    while(pos < data.length() && AsyncClient::peer && AsyncClient::peer->connected()) {
+        size_t piece = random(1, SPLIT_MAX + 1);
+        if(piece > data.length() - pos) {
+            piece = data.length() - pos;
+        }
+        AsyncClient::peer->hostReceive((const uint8_t *) data.data() + pos, piece);
+        pos += piece;
+    }
+}
+
+void remoteClose(void) {
+    if(AsyncClient::peer) {
+        AsyncClient::peer->hostClose();
+    }
+}
+
+class ParityClient: public WebSocketsClient {
+};
+
+#else
+
+// WebSocketsLoopback: connected in loop() (refused: not linked), data is read in loop()
+
+WebSocketsLoopback * remote = NULL;
+
+void remotePoll(void) {
+    uint8_t buffer[256];
+    int n;
+    while(remote && (n = remote->read(buffer, sizeof(buffer))) > 0) {
+        wire.append((const char *) buffer, n);
+    }
+}
+
+void remoteWrite(const std::string & data) {
+    if(remote) {
+        remote->write((const uint8_t *) data.data(), data.length());
+    }
+}
+
+void remoteClose(void) {
+    if(remote) {
+        remote->stop();
+    }
+}
+
+class ParityClient: public WebSocketsClient {
+    protected:
+        WebSocketsTransport * createTransport() {
+            remotePoll();
+            remoteConnect();
+            delete remote;
+            remote = NULL;
+
+            WebSocketsLoopback * end = new WebSocketsLoopback(PIPE_SIZE);
+            if(!refuse) {
+                remote = new WebSocketsLoopback(PIPE_SIZE);
+                end->link(remote);
+            }
+            return end;
+        }
+};
+
+#endif
+
+ParityClient client;
+
+//#################################################################################
+// client side
+
+const char * typeName(WStype_t type) {
+    switch(type) {
+        case WStype_ERROR:
+            return "ERROR";
+        case WStype_DISCONNECTED:
+            return "DISCONNECTED";
+        case WStype_CONNECTED:
+            return "CONNECTED";
+        case WStype_TEXT:
+            return "TEXT";
+        case WStype_BIN:
+            return "BIN";
+        case WStype_FRAGMENT_TEXT_START:
+            return "FRAGMENT_TEXT_START";
+        case WStype_FRAGMENT_BIN_START:
+            return "FRAGMENT_BIN_START";
+        case WStype_FRAGMENT:
+            return "FRAGMENT";
+        case WStype_FRAGMENT_FIN:
+            return "FRAGMENT_FIN";
+        case WStype_PING:
+            return "PING";
+        case WStype_PONG:
+            return "PONG";
+        default:
+            return "?";
+    }
+}
+
+bool connected = false;
+
+void clientEvent(WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_CONNECTED || type == WStype_DISCONNECTED) {
+        connected = (type == WStype_CONNECTED);
+    }
+    if(type == WStype_CONNECTED) {
+        note("client: %s %.*s", typeName(type), (int) length, (const char *) data);
+    } else {
+        note("client: %s %u %08x", typeName(type), (unsigned) length, hash(data, length));
+    }
+}
+
+void run(void) {
+    for(uint8_t i = 0; i < RUN_LOOPS; i++) {
+        remotePoll();
+        client.loop();
+        remotePoll();
+        remoteParse();
+    }
+}
+
+//#################################################################################
+
+const char * expected =
+        "test: refused\n"
+        "remote: connect 1\n"
+        "client: DISCONNECTED 0 811c9dc5\n"
+        "test: half the reconnect interval\n"
+        "test: reconnect interval over\n"
+        "remote: connect 2\n"
+        "remote: GET /parity HTTP/1.1\n"
+        "client: CONNECTED /parity\n"
+        "test: frames from the remote\n"
+        "client: TEXT 5 4f9f2cab\n"
+        "client: BIN 300 a85d4561\n"
+        "client: BIN 5000 526244ed\n"
+        "client: FRAGMENT_TEXT_START 4 8baade75\n"
+        "client: FRAGMENT 4 9ae4decd\n"
+        "client: FRAGMENT_FIN 2 371a55cc\n"
+        "client: PING 2 a04ed67a\n"
+        "remote: PONG 2 a04ed67a\n"
+        "test: frames from the client\n"
+        "remote: TEXT 3 1a47e90b\n"
+        "remote: BIN 1000 de5fea8d\n"
+        "remote: PING 2 9f4ed4e7\n"
+        "client: PONG 2 9f4ed4e7\n"
+        "test: close from the remote\n"
+        "client: DISCONNECTED 0 811c9dc5\n"
+        "remote: CLOSE unmasked 1000\n"
+        "remote: connect 3\n"
+        "remote: GET /parity HTTP/1.1\n"
+        "client: CONNECTED /parity\n"
+        "test: one reconnect interval later\n"
+        "test: connection lost\n"
+        "client: DISCONNECTED 0 811c9dc5\n"
+        "remote: connect 4\n"
+        "remote: GET /parity HTTP/1.1\n"
+        "client: CONNECTED /parity\n"
+        "test: one reconnect interval later\n"
+        "test: disconnect\n"
+        "client: DISCONNECTED 0 811c9dc5\n"
+        "remote: CLOSE unmasked 1000\n"
+        "remote: connect 5\n"
+        "remote: GET /parity HTTP/1.1\n"
+        "client: CONNECTED /parity\n";
+
+int main(void) {
+    randomSeed(1);
+    client.onEvent(clientEvent);
+    client.setReconnectInterval(RECONNECT_INTERVAL);
+
+    note("test: refused");
+    refuse = true;
+    client.begin("parity", 81, "/parity");
+    run();
+    note("test: half the reconnect interval");
+    hostAdvanceMillis(RECONNECT_INTERVAL / 2);
+    run();
+    note("test: reconnect interval over");
+    refuse = false;
+    hostAdvanceMillis(RECONNECT_INTERVAL / 2 + 1);
+    run();
+    CHECK(connected);
+
+    note("test: frames from the remote");
+    uint8_t payload[5000];
+    for(size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t) (i * 13);
+    }
+    std::string frames = frame(WSop_text, true, "hello");
+    frames += frame(WSop_binary, true, payload, 300);
+    frames += frame(WSop_binary, true, payload, sizeof(payload));
+    frames += frame(WSop_text, false, "frag");
+    frames += frame(WSop_continuation, false, "ment");
+    frames += frame(WSop_continuation, true, "ed");
+    frames += frame(WSop_ping, true, "p1");
+    remoteWrite(frames);
+    run();
+
+    note("test: frames from the client");
+    client.sendTXT("abc");
+    client.sendBIN(payload, 1000);
+    client.sendPing((uint8_t *) "p2", 2);
+    run();
+
+    // after a connection was up the reconnect is immediate (no failed attempts)
+    note("test: close from the remote");
+    uint8_t code[2] = { 1000 >> 8, 1000 & 0xFF };
+    remoteWrite(frame(WSop_close, true, code, sizeof(code)));
+    run();
+    note("test: one reconnect interval later");
+    hostAdvanceMillis(RECONNECT_INTERVAL + 1);
+    run();
+    CHECK(connected);
+
+    note("test: connection lost");
+    remoteClose();
+    run();
+    note("test: one reconnect interval later");
+    hostAdvanceMillis(RECONNECT_INTERVAL + 1);
+    run();
+    CHECK(connected);
+
+    note("test: disconnect");
+    client.disconnect();
+    run();
+
+    if(transcript != expected) {
+        printf("transcript:\n%s\nexpected:\n%s\n", transcript.c_str(), expected);
+    }
+    CHECK(transcript == expected);
+
+    return hostTestResult();
+}
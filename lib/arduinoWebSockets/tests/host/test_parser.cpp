@@ -0,0 +1,285 @@
+/**
+ * @file test_parser.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// incremental frame parser: both ends read through a WebSocketsLoopback that hands out
+// the bytes in random pieces of 0 - 9 byte (0: nothing available on this loop),
+// so header, extended length, mask and payload are split at every possible place;
+// masked (client -> server) and unmasked (server -> client) frames must arrive byte exact,
+// a frame that stops half way is closed with 1002 after WEBSOCKETS_TCP_TIMEOUT
+
+#include "HostTest.h"
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define SPLIT_MAX 9
+#define ROUNDS 20
+// the largest frame fits, a single threaded test can not wait on a full pipe
+#define PIPE_SIZE (WEBSOCKETS_MAX_DATA_SIZE + WEBSOCKETS_MAX_HEADER_SIZE)
+
+/**
+ * loopback end that returns at most a random small number of bytes per call
+ */
+class SplitLoopback: public WebSocketsLoopback {
+    public:
+        SplitLoopback() :
+                WebSocketsLoopback(PIPE_SIZE) {
+        }
+
+        int available(void) {
+            int length = WebSocketsLoopback::available();
+            int piece = random(SPLIT_MAX + 1);
+            return length < piece ? length : piece;
+        }
+
+        int read(uint8_t * buf, size_t size) {
+            size_t piece = random(1, SPLIT_MAX + 1);
+            return WebSocketsLoopback::read(buf, size < piece ? size : piece);
+        }
+        int read(void) {
+            return WebSocketsLoopback::read();
+        }
+};
+
+class LoopServer: public WebSocketsServer {
+    public:
+        LoopServer() :
+                WebSocketsServer(81, "", "arduino", 1) {
+        }
+
+        bool attach(WebSocketsLoopback * pipe) {
+            return newClient(pipe);
+        }
+
+        // loop() without accepting
+        void run() {
+            clientsRelease();
+            handleClientData();
+        }
+};
+
+LoopServer server;
+SplitLoopback * clientEnd = NULL;
+
+class LoopClient: public WebSocketsClient {
+    protected:
+        WebSocketsTransport * createTransport() {
+            SplitLoopback * end = new SplitLoopback();
+            SplitLoopback * serverEnd = new SplitLoopback();
+            end->link(serverEnd);
+            if(!server.attach(serverEnd)) {
+                delete serverEnd;
+            }
+            clientEnd = end;
+            return end;
+        }
+};
+
+LoopClient client;
+
+struct Side {
+    WStype_t type;  ///< of the last frame
+    size_t length;  ///< of the last frame
+    uint32_t frames;
+    uint32_t bad;
+    bool connected;
+    bool disconnected;
+};
+
+Side serverSide;
+Side clientSide;
+
+// payload byte i of a frame of length bytes
+uint8_t pattern(size_t i, size_t length) {
+    return (uint8_t) (i * 7 + length);
+}
+
+void fill(uint8_t * payload, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        payload[i] = pattern(i, length);
+    }
+}
+
+void check(Side & side, WStype_t type, uint8_t * data, size_t length) {
+    side.type   = type;
+    side.length = length;
+    side.frames++;
+    for(size_t i = 0; i < length; i++) {
+        if(data[i] != pattern(i, length)) {
+            side.bad++;
+            break;
+        }
+    }
+}
+
+void serverEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+    switch(type) {
+        case WStype_CONNECTED:
+            serverSide.connected = true;
+            break;
+        case WStype_DISCONNECTED:
+            serverSide.disconnected = true;
+            break;
+        case WStype_TEXT:
+        case WStype_BIN:
+        case WStype_PONG:
+            check(serverSide, type, data, length);
+            break;
+        default:
+            break;
+    }
+}
+
+void clientEvent(WStype_t type, uint8_t * data, size_t length) {
+    switch(type) {
+        case WStype_CONNECTED:
+            clientSide.connected = true;
+            break;
+        case WStype_DISCONNECTED:
+            clientSide.disconnected = true;
+            break;
+        case WStype_TEXT:
+        case WStype_BIN:
+        case WStype_PONG:
+            check(clientSide, type, data, length);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * run both sides until the receiving side has one more frame
+ * @param side Side &
+ * @return bool  frame arrived
+ */
+bool receive(Side & side, uint32_t frames) {
+    for(uint32_t i = 0; i < 100000 && side.frames == frames; i++) {
+        server.run();
+        client.loop();
+    }
+    return side.frames == frames + 1;
+}
+
+// every length class: 7 bit, 16 bit, 16 bit limit of the 7 bit field, larger
+const size_t lengths[] = { 0, 1, 2, 9, 124, 125, 126, 127, 128, 255, 256, 1000, 1460, 4096, WEBSOCKETS_MAX_DATA_SIZE - 1 };
+
+void frames(void) {
+    uint8_t * payload = (uint8_t *) malloc(WEBSOCKETS_MAX_DATA_SIZE);
+    for(uint8_t round = 0; round < ROUNDS; round++) {
+        for(size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+            size_t length = lengths[n];
+            fill(payload, length);
+            bool text = (round + n) & 1;
+            // sendTXT() takes length 0 as strlen()
+            const char * empty = "";
+            uint8_t * data = (text && !length) ? (uint8_t *) empty : payload;
+
+            // masked
+            uint32_t count = serverSide.frames;
+            if(text) {
+                client.sendTXT(data, length);
+            } else {
+                client.sendBIN(payload, length);
+            }
+            CHECK(receive(serverSide, count));
+            CHECK_EQ(serverSide.type, text ? WStype_TEXT : WStype_BIN);
+            CHECK_EQ(serverSide.length, length);
+
+            // unmasked
+            count = clientSide.frames;
+            if(text) {
+                server.sendTXT(0, data, length);
+            } else {
+                server.sendBIN(0, payload, length);
+            }
+            CHECK(receive(clientSide, count));
+            CHECK_EQ(clientSide.type, text ? WStype_TEXT : WStype_BIN);
+            CHECK_EQ(clientSide.length, length);
+        }
+
+        // control frame with payload, answered by the other side
+        uint8_t ping[WEBSOCKETS_MAX_HEADER_SIZE + 100];
+        fill(ping, 100);
+        uint32_t count = clientSide.frames;
+        client.sendPing(ping, 100);
+        CHECK(receive(clientSide, count));
+        CHECK_EQ(clientSide.type, WStype_PONG);
+        CHECK_EQ(clientSide.length, 100);
+    }
+    free(payload);
+
+    CHECK_EQ(serverSide.bad, 0);
+    CHECK_EQ(clientSide.bad, 0);
+    CHECK(!serverSide.disconnected);
+    CHECK(!clientSide.disconnected);
+}
+
+/**
+ * a masked frame announces 100 byte but only 10 arrive
+ */
+void stall(void) {
+    uint8_t frame[2 + 4 + 10] = { 0x82, 0x80 | 100, 1, 2, 3, 4 };
+    CHECK_EQ(clientEnd->write(frame, sizeof(frame)), sizeof(frame));
+
+    for(uint16_t i = 0; i < 1000; i++) {
+        server.run();
+    }
+    CHECK_EQ(server.connectedClients(), 1);
+    CHECK(!serverSide.disconnected);
+
+    hostAdvanceMillis(WEBSOCKETS_TCP_TIMEOUT + 1);
+    for(uint16_t i = 0; i < 1000 && !clientSide.disconnected; i++) {
+        server.run();
+        client.loop();
+    }
+    CHECK(serverSide.disconnected);
+    CHECK(clientSide.disconnected);
+    CHECK_EQ(server.connectedClients(), 0);
+}
+
+int main(void) {
+    randomSeed(1);
+    server.onEvent(serverEvent);
+    client.onEvent(clientEvent);
+    client.begin("loopback", 81, "/");
+
+    for(uint32_t i = 0; i < 10000 && !(clientSide.connected && serverSide.connected); i++) {
+        client.loop();
+        server.run();
+    }
+    CHECK(clientSide.connected);
+    CHECK(serverSide.connected);
+
+    // settle (ping / pong after the handshake)
+    for(uint16_t i = 0; i < 1000; i++) {
+        server.run();
+        client.loop();
+    }
+
+    frames();
+    stall();
+
+    return hostTestResult();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_pool.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// connect / disconnect cycles of two clients: the server keeps the client struct of a slot
+// and hands the handshake state back to its pool once the connection is upgraded,
+// the structs of the first connections serve all later ones
+
+#include "HostTest.h"
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define PIPE_SIZE 2920
+#define CYCLES 50
+
+class LoopServer: public WebSocketsServer {
+    public:
+        LoopServer() :
+                WebSocketsServer(81, "", "arduino", 2) {
+        }
+
+        bool attach(WebSocketsLoopback * pipe) {
+            return newClient(pipe);
+        }
+
+        // loop() without accepting
+        void run() {
+            clientsRelease();
+            handleClientData();
+        }
+
+        WSclient_t * slot(uint8_t num) {
+            return clientByNum(num);
+        }
+
+        uint8_t headersFree(void) {
+            return _headersFree;
+        }
+};
+
+LoopServer server;
+
+class LoopClient: public WebSocketsClient {
+    protected:
+        WebSocketsTransport * createTransport() {
+            WebSocketsLoopback * end = new WebSocketsLoopback(PIPE_SIZE);
+            WebSocketsLoopback * serverEnd = new WebSocketsLoopback(PIPE_SIZE);
+            end->link(serverEnd);
+            if(!server.attach(serverEnd)) {
+                delete serverEnd;
+            }
+            return end;
+        }
+};
+
+LoopClient a;
+LoopClient b;
+
+uint32_t connects = 0;
+uint32_t disconnects = 0;
+
+void serverEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_CONNECTED) {
+        connects++;
+    } else if(type == WStype_DISCONNECTED) {
+        disconnects++;
+    }
+}
+
+void run(void) {
+    for(uint16_t i = 0; i < 100; i++) {
+        server.run();
+        a.loop();
+        b.loop();
+    }
+}
+
+/**
+ * both slots hold the struct of the first connection, the handshake state is back in the pool
+ */
+void checkSlots(WSclient_t ** slots) {
+    for(uint8_t num = 0; num < 2; num++) {
+        WSclient_t * client = server.slot(num);
+        CHECK(client != NULL);
+        CHECK(client == slots[num]);
+        CHECK(client && client->header == NULL);
+    }
+    CHECK_EQ(server.headersFree(), 2);
+    CHECK_EQ(server.connectedClients(), 2);
+}
+
+int main(void) {
+    server.onEvent(serverEvent);
+    a.begin("loopback", 81, "/");
+    b.begin("loopback", 81, "/");
+    run();
+    CHECK_EQ(connects, 2);
+
+    WSclient_t * slots[2] = { server.slot(0), server.slot(1) };
+    checkSlots(slots);
+
+    // the client connects again right after the close
+    for(uint32_t cycle = 1; cycle <= CYCLES; cycle++) {
+        a.disconnect();
+        b.disconnect();
+        run();
+        CHECK_EQ(disconnects, 2 * cycle);
+        CHECK_EQ(connects, 2 * (cycle + 1));
+        checkSlots(slots);
+    }
+
+    return hostTestResult();
+}
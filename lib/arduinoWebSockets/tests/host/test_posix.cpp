@@ -0,0 +1,114 @@
+/**
+ * @file test_posix.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// NETWORK_POSIX backend: WebSocketsClient and WebSocketsServer over localhost,
+// handshake, echo of small and big frames (partial socket writes / reads), close
+
+#include "HostTest.h"
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define TEST_PORT 18181
+#define TEST_TIMEOUT 5000
+
+WebSocketsServer server = WebSocketsServer(TEST_PORT);
+WebSocketsClient client;
+
+bool connected = false;
+bool disconnected = false;
+uint32_t echoes = 0;
+uint32_t bad = 0;
+
+uint8_t payload[WEBSOCKETS_MAX_DATA_SIZE];
+size_t expected = 0;
+
+void serverEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_BIN) {
+        server.sendBIN(num, data, length);
+    }
+}
+
+void clientEvent(WStype_t type, uint8_t * data, size_t length) {
+    switch(type) {
+        case WStype_CONNECTED:
+            connected = true;
+            break;
+        case WStype_DISCONNECTED:
+            disconnected = true;
+            break;
+        case WStype_BIN:
+            echoes++;
+            if(length != expected || (length && memcmp(data, payload, length) != 0)) {
+                bad++;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * run both sides until done() or TEST_TIMEOUT
+ */
+template<typename F>
+bool runUntil(F done) {
+    unsigned long start = millis();
+    while(!done()) {
+        if(millis() - start > TEST_TIMEOUT) {
+            return false;
+        }
+        server.loop();
+        client.loop();
+    }
+    return true;
+}
+
+int main(void) {
+    for(size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = random(0x100);
+    }
+
+    server.begin();
+    server.onEvent(serverEvent);
+    client.begin("127.0.0.1", TEST_PORT, "/");
+    client.onEvent(clientEvent);
+
+    CHECK(runUntil([]() { return connected && server.connectedClients() == 1; }));
+
+    static const size_t sizes[] = { 0, 1, 125, 126, 1460, 4096, sizeof(payload) };
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        expected = sizes[s];
+        uint32_t before = echoes;
+        client.sendBIN(payload, expected);
+        CHECK(runUntil([before]() { return echoes > before; }));
+    }
+    CHECK_EQ(echoes, sizeof(sizes) / sizeof(sizes[0]));
+    CHECK_EQ(bad, 0);
+
+    client.disconnect();
+    CHECK(runUntil([]() { return disconnected && server.connectedClients() == 0; }));
+
+    return hostTestResult();
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_probe.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// ping probes of the client: pingRTT of the answered probe, pingSilence counts from the
+// oldest unanswered probe while the server does not answer and is 0 again after a pong
+
+#include "HostTest.h"
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define PIPE_SIZE 2920
+
+class LoopServer: public WebSocketsServer {
+    public:
+        LoopServer() :
+                WebSocketsServer(81, "", "arduino", 1) {
+        }
+
+        bool attach(WebSocketsLoopback * pipe) {
+            return newClient(pipe);
+        }
+
+        // loop() without accepting
+        void run() {
+            clientsRelease();
+            handleClientData();
+        }
+};
+
+LoopServer server;
+
+class LoopClient: public WebSocketsClient {
+    protected:
+        WebSocketsTransport * createTransport() {
+            WebSocketsLoopback * end = new WebSocketsLoopback(PIPE_SIZE);
+            WebSocketsLoopback * serverEnd = new WebSocketsLoopback(PIPE_SIZE);
+            end->link(serverEnd);
+            if(!server.attach(serverEnd)) {
+                delete serverEnd;
+            }
+            return end;
+        }
+};
+
+LoopClient client;
+
+bool connected = false;
+uint32_t rtt = 0;
+uint32_t pongs = 0;
+
+void clientEvent(WStype_t type, uint8_t * data, size_t length) {
+    switch(type) {
+        case WStype_CONNECTED:
+            connected = true;
+            break;
+        case WStype_DISCONNECTED:
+            connected = false;
+            break;
+        case WStype_PONG:
+            pongs++;
+            rtt = client.pingRTT();
+            break;
+        default:
+            break;
+    }
+}
+
+void run(void) {
+    for(uint16_t i = 0; i < 100; i++) {
+        server.run();
+        client.loop();
+    }
+}
+
+int main(void) {
+    client.onEvent(clientEvent);
+    client.begin("loopback", 81, "/");
+    run();
+    CHECK(connected);
+    CHECK_EQ(client.pingSilence(), 0);
+
+    // answered
+    uint32_t count = pongs;
+    CHECK(client.sendPingProbe());
+    CHECK(client.pingSilence() > 0);
+    run();
+    CHECK_EQ(pongs, count + 1);
+    CHECK(rtt > 0);
+    CHECK_EQ(client.pingSilence(), 0);
+
+    // the server does not answer, silence counts from the first probe
+    CHECK(client.sendPingProbe());
+    hostAdvanceMillis(1000);
+    CHECK(client.sendPingProbe());
+    hostAdvanceMillis(1500);
+    client.loop();
+    CHECK(client.pingSilence() >= 2500);
+
+    // late answers end the silence
+    run();
+    CHECK_EQ(client.pingSilence(), 0);
+
+    // not connected: no silence
+    CHECK(client.sendPingProbe());
+    client.disconnect();
+    CHECK(!connected);
+    CHECK_EQ(client.pingSilence(), 0);
+
+    return hostTestResult();
+}
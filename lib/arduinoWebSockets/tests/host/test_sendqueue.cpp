@@ -0,0 +1,199 @@
+/**
+ * @file test_sendqueue.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// send queue of the client (user setting of the node: drop oldest, max age) over a small
+// WebSocketsLoopback pipe that the server does not read until the end:
+// a frame that is partly written before it is queued must neither expire nor be dropped,
+// the server has to receive every frame that was not dropped, byte exact
+
+#include "HostTest.h"
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+#define PIPE_SIZE 512
+#define FRAME_LENGTH 400
+#define MAX_AGE 50
+
+class LoopServer: public WebSocketsServer {
+    public:
+        LoopServer() :
+                WebSocketsServer(81, "", "arduino", 1) {
+        }
+
+        bool attach(WebSocketsLoopback * pipe) {
+            return newClient(pipe);
+        }
+
+        // loop() without accepting
+        void run() {
+            clientsRelease();
+            handleClientData();
+        }
+};
+
+LoopServer server;
+
+class LoopClient: public WebSocketsClient {
+    protected:
+        WebSocketsTransport * createTransport() {
+            WebSocketsLoopback * end = new WebSocketsLoopback(PIPE_SIZE);
+            WebSocketsLoopback * serverEnd = new WebSocketsLoopback(PIPE_SIZE);
+            end->link(serverEnd);
+            if(!server.attach(serverEnd)) {
+                delete serverEnd;
+            }
+            return end;
+        }
+};
+
+LoopClient client;
+
+bool connected = false;
+bool disconnected = false;
+uint8_t received[32];
+uint8_t receivedCount = 0;
+uint32_t bad = 0;
+
+// every frame is FRAME_LENGTH times its number
+void fill(uint8_t * frame, uint8_t number) {
+    memset(frame, number, FRAME_LENGTH);
+}
+
+void serverEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_BIN) {
+        uint8_t expected[FRAME_LENGTH];
+        fill(expected, data[0]);
+        if(length != FRAME_LENGTH || memcmp(data, expected, length) != 0) {
+            bad++;
+        }
+        if(receivedCount < sizeof(received)) {
+            received[receivedCount++] = data[0];
+        }
+    }
+}
+
+void clientEvent(WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_CONNECTED) {
+        connected = true;
+    } else if(type == WStype_DISCONNECTED) {
+        disconnected = true;
+    }
+}
+
+void send(uint8_t number) {
+    uint8_t frame[FRAME_LENGTH];
+    fill(frame, number);
+    client.sendBIN(frame, sizeof(frame));
+}
+
+/**
+ * run both sides until the client queue is empty and the pipe is read
+ */
+void drain(void) {
+    for(uint16_t i = 0; i < 1000 && client.sendQueueStats().entries; i++) {
+        server.run();
+        client.loop();
+    }
+    for(uint16_t i = 0; i < 100; i++) {
+        server.run();
+        client.loop();
+    }
+}
+
+/**
+ * fill the pipe, so the second frame is partly written and the rest is queued,
+ * then fill the queue with more frames
+ * @param maxAge unsigned long  0: only the drop oldest policy can take frames
+ */
+void partialFrame(unsigned long maxAge) {
+    client.setSendQueue(WEBSOCKETS_TX_QUEUE_DEPTH, maxAge, WSqueue_dropOldest);
+    receivedCount = 0;
+    uint32_t dropped = client.sendQueueStats().dropped;
+
+    // 1 fits in to the pipe, 2 only partly, the rest of 2 is queued
+    send(1);
+    send(2);
+    WSqueueStats_t stats = client.sendQueueStats();
+    CHECK_EQ(stats.entries, 1);
+    CHECK(stats.bytes < FRAME_LENGTH);
+
+    // older than max age, but a part is on the wire
+    hostAdvanceMillis(MAX_AGE * 2);
+    client.loop();
+    stats = client.sendQueueStats();
+    CHECK_EQ(stats.entries, 1);
+    CHECK_EQ(stats.dropped, dropped);
+
+    // queue full: drop oldest may not take frame 2, so the new frame is dropped
+    uint8_t number = 3;
+    uint8_t queued = 0;
+    while(client.sendQueueStats().dropped == dropped && number < 20) {
+        send(number++);
+        queued++;
+    }
+    stats = client.sendQueueStats();
+    CHECK_EQ(stats.dropped, dropped + 1);
+    CHECK_EQ(stats.entries, queued);
+
+    // frames completely in the queue still expire
+    hostAdvanceMillis(MAX_AGE * 2);
+    drain();
+
+    stats = client.sendQueueStats();
+    CHECK_EQ(stats.entries, 0);
+    CHECK_EQ(bad, 0);
+    CHECK(!disconnected);
+    CHECK(receivedCount >= 2);
+    CHECK_EQ(received[0], 1);
+    CHECK_EQ(received[1], 2);
+    if(maxAge) {
+        CHECK_EQ(stats.dropped, dropped + queued);
+        CHECK_EQ(receivedCount, 2);
+    } else {
+        CHECK_EQ(stats.dropped, dropped + 1);
+        CHECK_EQ(receivedCount, queued + 1);
+    }
+}
+
+int main(void) {
+    server.onEvent(serverEvent);
+    client.onEvent(clientEvent);
+    client.begin("loopback", 81, "/");
+
+    for(uint16_t i = 0; i < 100 && !connected; i++) {
+        client.loop();
+        server.run();
+    }
+    CHECK(connected);
+
+    // settle (ping / pong after the handshake), the pipe is empty afterwards
+    drain();
+    CHECK_EQ(client.sendQueueStats().entries, 0);
+
+    partialFrame(MAX_AGE);
+    partialFrame(0);
+
+    return hostTestResult();
+}
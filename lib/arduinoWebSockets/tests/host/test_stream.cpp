@@ -0,0 +1,237 @@
+/**
+ * @file test_stream.cpp
+ * @date 19.10.2026
+ * @author Arseniy Churin
+ *
+ * Copyright (c) 2026 Arseniy Churin. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// streamed message of the server (sendBINStream) to client a, the producer sends a text
+// to client b for every chunk: the clients of the server share the transmit arena,
+// the chunk must not be overwritten by that send; both streams from the client side too;
+// a stream that is still queued when the server stops reading is closed with 1011
+
+#include "HostTest.h"
+
+#include <WebSocketsServer.h>
+#include <WebSocketsClient.h>
+
+// the whole message fits, nobody reads while sendStream() waits for the pipe
+#define PIPE_SIZE (16 * 1024)
+#define CHUNK WEBSOCKETS_TX_ARENA_PAYLOAD
+#define CHUNKS 5
+#define LAST_CHUNK 100
+// more than the pipe, less than pipe and send queue
+#define STALL_PIPE_SIZE 512
+#define STALL_CHUNK 200
+
+class LoopServer: public WebSocketsServer {
+    public:
+        LoopServer() :
+                WebSocketsServer(81, "", "arduino", 3) {
+        }
+
+        bool attach(WebSocketsLoopback * pipe) {
+            return newClient(pipe);
+        }
+
+        // loop() without accepting
+        void run() {
+            clientsRelease();
+            handleClientData();
+        }
+};
+
+LoopServer server;
+
+class LoopClient: public WebSocketsClient {
+    public:
+        LoopClient(size_t pipeSize = PIPE_SIZE) :
+                _pipeSize(pipeSize) {
+        }
+
+    protected:
+        size_t _pipeSize;
+
+        WebSocketsTransport * createTransport() {
+            WebSocketsLoopback * end = new WebSocketsLoopback(_pipeSize);
+            WebSocketsLoopback * serverEnd = new WebSocketsLoopback(_pipeSize);
+            end->link(serverEnd);
+            if(!server.attach(serverEnd)) {
+                delete serverEnd;
+            }
+            return end;
+        }
+};
+
+LoopClient a;
+LoopClient b;
+LoopClient c(STALL_PIPE_SIZE);
+
+struct Received {
+    bool connected;
+    uint32_t fragments; ///< of the streamed message
+    uint32_t texts;
+    size_t bytes;
+    uint32_t bad;
+    bool fin;
+};
+
+Received receivedA;
+Received receivedB;
+Received receivedServer;
+Received receivedC;
+bool disconnectedC = false;
+
+// byte i of chunk n
+uint8_t pattern(uint32_t n, size_t i) {
+    return (uint8_t) (n * 31 + i);
+}
+
+void fragment(Received & r, WStype_t type, uint8_t * data, size_t length) {
+    switch(type) {
+        case WStype_CONNECTED:
+            r.connected = true;
+            break;
+        case WStype_TEXT:
+            r.texts++;
+            if(length != 5 || memcmp(data, "other", 5) != 0) {
+                r.bad++;
+            }
+            break;
+        case WStype_FRAGMENT_BIN_START:
+        case WStype_FRAGMENT:
+        case WStype_FRAGMENT_FIN:
+            for(size_t i = 0; i < length; i++) {
+                if(data[i] != pattern(r.fragments, i)) {
+                    r.bad++;
+                    break;
+                }
+            }
+            r.fragments++;
+            r.bytes += length;
+            r.fin = (type == WStype_FRAGMENT_FIN);
+            break;
+        default:
+            break;
+    }
+}
+
+void eventA(WStype_t type, uint8_t * data, size_t length) {
+    fragment(receivedA, type, data, length);
+}
+
+void eventB(WStype_t type, uint8_t * data, size_t length) {
+    fragment(receivedB, type, data, length);
+}
+
+void eventC(WStype_t type, uint8_t * data, size_t length) {
+    if(type == WStype_DISCONNECTED) {
+        disconnectedC = true;
+    }
+    fragment(receivedC, type, data, length);
+}
+
+void serverEvent(uint8_t num, WStype_t type, uint8_t * data, size_t length) {
+    fragment(receivedServer, type, data, length);
+}
+
+uint32_t produced = 0;
+
+size_t producer(uint8_t * buffer, size_t size) {
+    size_t length = (produced < CHUNKS - 1) ? size : LAST_CHUNK;
+    for(size_t i = 0; i < length; i++) {
+        buffer[i] = pattern(produced, i);
+    }
+    produced++;
+    return length;
+}
+
+// the server producer sends to the other client (b is client 1) with every chunk
+size_t producerSending(uint8_t * buffer, size_t size) {
+    size_t length = producer(buffer, size);
+    server.sendTXT(1, "other");
+    return length;
+}
+
+void run(void) {
+    for(uint16_t i = 0; i < 200; i++) {
+        server.run();
+        a.loop();
+        b.loop();
+    }
+}
+
+int main(void) {
+    server.onEvent(serverEvent);
+    a.onEvent(eventA);
+    b.onEvent(eventB);
+
+    a.begin("loopback", 81, "/");
+    for(uint16_t i = 0; i < 100 && !receivedA.connected; i++) {
+        a.loop();
+        server.run();
+    }
+    b.begin("loopback", 81, "/");
+    for(uint16_t i = 0; i < 100 && !receivedB.connected; i++) {
+        b.loop();
+        server.run();
+    }
+    CHECK(receivedA.connected);
+    CHECK(receivedB.connected);
+    run();
+
+    // server -> a, sending to b in between
+    CHECK(server.sendBINStream(0, producerSending, CHUNK));
+    run();
+    CHECK_EQ(receivedA.fragments, CHUNKS);
+    CHECK_EQ(receivedA.bytes, (CHUNKS - 1) * CHUNK + LAST_CHUNK);
+    CHECK(receivedA.fin);
+    CHECK_EQ(receivedA.bad, 0);
+    CHECK_EQ(receivedA.texts, 0);
+    CHECK_EQ(receivedB.texts, CHUNKS);
+    CHECK_EQ(receivedB.bad, 0);
+
+    // a -> server, the client stream uses its own arena
+    produced = 0;
+    CHECK(a.sendBINStream(producer, CHUNK));
+    run();
+    CHECK_EQ(receivedServer.fragments, CHUNKS);
+    CHECK_EQ(receivedServer.bytes, (CHUNKS - 1) * CHUNK + LAST_CHUNK);
+    CHECK(receivedServer.fin);
+    CHECK_EQ(receivedServer.bad, 0);
+
+    // c -> server, the server stops reading: the tail stays in the send queue
+    c.onEvent(eventC);
+    c.begin("loopback", 81, "/");
+    for(uint16_t i = 0; i < 100 && !receivedC.connected; i++) {
+        c.loop();
+        server.run();
+    }
+    CHECK(receivedC.connected);
+    for(uint16_t i = 0; i < 100; i++) {
+        server.run();
+        c.loop();
+    }
+    produced = 0;
+    CHECK(!c.sendBINStream(producer, STALL_CHUNK));
+    CHECK(disconnectedC);
+
+    return hostTestResult();
+}
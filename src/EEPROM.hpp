@@ -10,6 +10,8 @@
 #define EEPROM_HPP
 
 #define COLOR_ADDRESS 100
+#define JOIN_ADDRESS 120
+#define BRIDGES_ADDRESS 150
 
 #include <EEPROM.h>
 #include <Arduino.h>
@@ -213,6 +215,46 @@ void ReadRGB(uint16_t *buf, uint16_t address)
     delete[] pre;
 }
 
+/**
+ * @brief Write raw bytes in memory
+ * 
+ * Content bytes followed by "ok" check
+ * 
+ * @param address Start address
+ * @param buf content
+ * @param len length of content
+ */
+void SaveBytes(uint16_t address, const uint8_t *buf, uint8_t len)
+{
+    EEPROM.begin(512);
+    for (uint8_t i = 0; i < len; i++)
+        EEPROM.write(address++, buf[i]);
+
+    EEPROM.write(address++, 'o');
+    EEPROM.write(address, 'k');
+
+    EEPROM.commit();
+}
+
+/**
+ * @brief Read raw bytes from memory
+ * 
+ * @param address Start address
+ * @param buf content
+ * @param len length of content
+ * @return true if the "ok" check matches
+ */
+bool ReadBytes(uint16_t address, uint8_t *buf, uint8_t len)
+{
+    EEPROM.begin(512);
+    for (uint8_t i = 0; i < len; i++)
+        buf[i] = EEPROM.read(address++);
+
+    bool ok = EEPROM.read(address) == 'o' && EEPROM.read(address + 1) == 'k';
+    EEPROM.end();
+    return ok;
+}
+
 void ClearMemory()
 {
     int SIZE = 512;
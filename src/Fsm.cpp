@@ -0,0 +1,79 @@
+/**
+ * @brief Table driven state machine realization
+ *
+ * @file Fsm.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "Fsm.h"
+
+Fsm::Fsm(const FsmStateDef *states, uint8_t stateCount,
+         const FsmTransition *table, uint8_t transitionCount,
+         FsmState initial, FsmClock clock)
+{
+    _states = states;
+    _stateCount = stateCount;
+    _table = table;
+    _transitionCount = transitionCount;
+    _clock = clock;
+    _state = initial < stateCount ? initial : 0;
+    _last = {_state, _state, 0, 0, 0};
+}
+
+const char *Fsm::name(FsmState state) const
+{
+    return state < _stateCount ? _states[state].name : "?";
+}
+
+const FsmTransition *Fsm::find(FsmEvent event) const
+{
+    for (uint8_t i = 0; i < _transitionCount; ++i)
+    {
+        const FsmTransition &t = _table[i];
+        if (t.event != event || (t.from != FSM_ANY && t.from != _state))
+            continue;
+        if (t.guard && !t.guard())
+            continue;
+        return &t;
+    }
+    return NULL;
+}
+
+bool Fsm::dispatch(FsmEvent event)
+{
+    if (_busy)
+        return false;
+
+    const FsmTransition *t = find(event);
+    if (!t || t->to >= _stateCount)
+        return false;
+
+    _busy = true;
+
+    //Internal transition, state stays
+    if (t->to == _state)
+    {
+        if (t->action)
+            t->action();
+        _busy = false;
+        return true;
+    }
+
+    FsmTrace trace = {_state, t->to, event, _clock(), 0};
+
+    if (_states[_state].exit)
+        _states[_state].exit();
+    if (t->action)
+        t->action();
+    _state = t->to;
+    if (_states[_state].enter)
+        _states[_state].enter();
+
+    trace.duration = _clock() - trace.at;
+    _last = trace;
+    _busy = false;
+
+    if (_hook)
+        _hook(_last);
+    return true;
+}
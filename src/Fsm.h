@@ -0,0 +1,125 @@
+/**
+ * @brief Table driven state machine
+ *
+ * States with entry / exit actions and a transition table
+ * (from, event, to, guard, action). No Arduino dependency,
+ * the clock is passed in, so it runs on the host as well.
+ *
+ * @file Fsm.h
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#ifndef FSM_H
+#define FSM_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+typedef uint8_t FsmState;
+typedef uint8_t FsmEvent;
+
+//Transition from any state
+#define FSM_ANY 0xFF
+
+typedef bool (*FsmGuard)();
+typedef void (*FsmAction)();
+typedef uint32_t (*FsmClock)();
+
+/**
+ * @brief State definition, index in the table is the state
+ */
+struct FsmStateDef
+{
+  const char *name;
+  FsmAction enter;
+  FsmAction exit;
+  uint8_t data; //per state setting of the user (e.g. radio profile)
+};
+
+/**
+ * @brief Transition, first matching row wins
+ *
+ * to == current state: internal transition, only the action runs
+ */
+struct FsmTransition
+{
+  FsmState from; //state or FSM_ANY
+  FsmEvent event;
+  FsmState to;
+  FsmGuard guard;   //NULL = always
+  FsmAction action; //runs between exit and enter
+};
+
+/**
+ * @brief Time stamp and duration of a transition (clock units)
+ */
+struct FsmTrace
+{
+  FsmState from;
+  FsmState to;
+  FsmEvent event;
+  uint32_t at;
+  uint32_t duration;
+};
+
+typedef void (*FsmHook)(const FsmTrace &trace);
+
+class Fsm
+{
+public:
+  /**
+   * @brief Construct a new Fsm object
+   *
+   * @param states state definitions, indexed by state
+   * @param stateCount
+   * @param table transitions
+   * @param transitionCount
+   * @param initial state, its entry action is not run
+   * @param clock time source for the traces (e.g. micros)
+   */
+  Fsm(const FsmStateDef *states, uint8_t stateCount,
+      const FsmTransition *table, uint8_t transitionCount,
+      FsmState initial, FsmClock clock);
+
+  /**
+   * @brief Handle event
+   *
+   * Events from inside an action are refused.
+   *
+   * @param event
+   * @return true if a transition was taken
+   */
+  bool dispatch(FsmEvent event);
+
+  /**
+   * @brief Called after every transition to another state
+   *
+   * @param hook
+   */
+  void onTransition(FsmHook hook) { _hook = hook; }
+
+  FsmState state() const { return _state; }
+  const FsmStateDef &def() const { return _states[_state]; }
+  const char *name(FsmState state) const;
+
+  /**
+   * @brief Last transition to another state
+   */
+  const FsmTrace &last() const { return _last; }
+
+private:
+  const FsmTransition *find(FsmEvent event) const;
+
+  const FsmStateDef *_states;
+  uint8_t _stateCount;
+  const FsmTransition *_table;
+  uint8_t _transitionCount;
+  FsmClock _clock;
+  FsmHook _hook = NULL;
+
+  FsmState _state;
+  FsmTrace _last;
+  bool _busy = false;
+};
+
+#endif
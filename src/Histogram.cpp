@@ -0,0 +1,44 @@
+/**
+ * @brief Fixed bucket histogram realization
+ *
+ * @file Histogram.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "Histogram.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void Histogram::reset()
+{
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _max = 0;
+}
+
+void Histogram::write(uint8_t *buf) const
+{
+    memcpy(buf, &_count, sizeof(_count));
+    memcpy(buf + sizeof(_count), &_max, sizeof(_max));
+    memcpy(buf + 2 * sizeof(uint32_t), _buckets, sizeof(_buckets));
+}
+
+void Histogram::dump(const char *name, HistLine line) const
+{
+    char text[HIST_LINE];
+    snprintf(text, sizeof(text), "Stage %s: %u runs, max %u cycles\n", name, (unsigned)_count, (unsigned)_max);
+    line(text);
+    for (int b = 0; b < HIST_BUCKETS - 1; ++b)
+    {
+        if (!_buckets[b])
+            continue;
+        snprintf(text, sizeof(text), "  < 2^%u: %u\n", HIST_FIRST_SHIFT + b, _buckets[b]);
+        line(text);
+    }
+    if (_buckets[HIST_BUCKETS - 1])
+    {
+        snprintf(text, sizeof(text), "  >= 2^%u: %u\n", HIST_FIRST_SHIFT + HIST_BUCKETS - 2, _buckets[HIST_BUCKETS - 1]);
+        line(text);
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * @brief Fixed bucket histogram of durations (CPU cycles)
+ *
+ * Power of two buckets: bucket 0 < 2^HIST_FIRST_SHIFT cycles,
+ * bucket i in [2^(HIST_FIRST_SHIFT + i - 1), 2^(HIST_FIRST_SHIFT + i)),
+ * last bucket takes everything above. No Arduino dependency.
+ *
+ * @file Histogram.h
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+//2^8 cycles: 3.2 us at 80 MHz, last bucket from 2^22: 52 ms
+#define HIST_BUCKETS 16
+#define HIST_FIRST_SHIFT 8
+
+//Longest line of dump()
+#define HIST_LINE 64
+
+typedef void (*HistLine)(const char *line);
+
+class Histogram
+{
+public:
+  /**
+   * @brief Add one duration
+   *
+   * @param cycles
+   */
+  void add(uint32_t cycles)
+  {
+    uint8_t bucket = 0;
+    if (cycles >> HIST_FIRST_SHIFT)
+    {
+      bucket = 32 - __builtin_clz(cycles >> HIST_FIRST_SHIFT);
+      if (bucket >= HIST_BUCKETS)
+        bucket = HIST_BUCKETS - 1;
+    }
+    if (_buckets[bucket] != 0xFFFF)
+      _buckets[bucket]++;
+    _count++;
+    if (cycles > _max)
+      _max = cycles;
+  }
+
+  void reset();
+
+  /**
+   * @brief Serialize: count, max (4 bytes each), buckets (2 bytes each)
+   *
+   * @param buf HIST_SIZE bytes
+   */
+  void write(uint8_t *buf) const;
+
+  /**
+   * @brief Print as text, one call per line (with newline)
+   *
+   * Header with runs and max, then the buckets that are not empty
+   *
+   * @param name
+   * @param line output, e.g. to Serial or stdout
+   */
+  void dump(const char *name, HistLine line) const;
+
+  uint32_t count() const { return _count; }
+  uint32_t longest() const { return _max; }
+  uint16_t bucket(uint8_t i) const { return _buckets[i]; }
+
+private:
+  uint16_t _buckets[HIST_BUCKETS] = {};
+  uint32_t _count = 0;
+  uint32_t _max = 0;
+};
+
+#define HIST_SIZE (2 * sizeof(uint32_t) + HIST_BUCKETS * sizeof(uint16_t))
+
+#endif
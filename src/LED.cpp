@@ -22,20 +22,21 @@ static const uint8_t D10  = 1;*/
 #include "LED.h"
 #include "math.h"
 
-#include <Ticker.h>
 
 LED::~LED() {}
 
 LED::LED(uint8_t Rpin, uint8_t Gpin, uint8_t Bpin)
 {
     r = Rpin;
-    pinMode(Rpin, OUTPUT);
-
     g = Gpin;
-    pinMode(Gpin, OUTPUT);
-
     b = Bpin;
-    pinMode(Bpin, OUTPUT);
+}
+
+void LED::begin()
+{
+    pinMode(r, OUTPUT);
+    pinMode(g, OUTPUT);
+    pinMode(b, OUTPUT);
     Off();
 }
 
@@ -68,25 +69,24 @@ void LED::smooth_blink(uint16_t frequency, bool delay)
 {
     delay_active = delay;
     current_step = 0;
-    led_ticker.attach_ms<LED *>(frequency, [](LED *led) {
-        if (led->delay_cycles > 0)
-            led->delay_cycles--;
+    led_task.attach_ms(frequency, [this]() {
+        if (delay_cycles > 0)
+            delay_cycles--;
         else
         {
-            led->current = calculate_values(led->current, led->steps, led->color, led->sec_color, led->rise);
+            current = calculate_values(current, steps, color, sec_color, rise);
 
-            if (++led->current_step == STEPS)
+            if (++current_step == STEPS)
             {
-                led->rise = !led->rise;
-                led->current_step = 0;
-                if (led->delay_active)
-                    led->delay_cycles = 20;
+                rise = !rise;
+                current_step = 0;
+                if (delay_active)
+                    delay_cycles = 20;
             }
 
-            led->set_color(led->current);
+            set_color(current);
         }
-    },
-                                this);
+    });
 }
 
 RGB LED::calculate_step(RGB prev, RGB end)
@@ -145,8 +145,8 @@ void LED::set_color(RGB col, bool alarm)
 
 void LED::switch_mode(Mode mode)
 {
-    led_ticker.detach();
-    ticker_killer.detach();
+    led_task.detach();
+    kill_task.detach();
     rise = true;
     _mode = mode;
 
@@ -227,15 +227,14 @@ void LED::Alarm()
 {
     stateSBlink({1023, 0, 0}, NONE);
 
-    led_ticker.attach_ms<LED *>(100, [](LED *led) {
-        if (led->rise)
-            led->set_color(led->color, true);
+    led_task.attach_ms(100, [this]() {
+        if (rise)
+            set_color(color, true);
         else
-            led->set_color(led->sec_color, true);
+            set_color(sec_color, true);
 
-        led->rise = !led->rise;
-    },
-                                this);
+        rise = !rise;
+    });
 
     killAfter(3000);
 }
@@ -269,36 +268,34 @@ void LED::SingleBlink(RGB col)
 
 void LED::killAfter(uint32_t milliseconds)
 {
-    ticker_killer.once_ms<LED *>(milliseconds, [](LED *led) {
-        led->led_ticker.detach();
-        switch (led->_prevmode)
+    kill_task.once_ms(milliseconds, [this]() {
+        led_task.detach();
+        switch (_prevmode)
         {
         case NaI:
-            led->Off();
+            Off();
             return;
             break;
         case CONSTANT:
-            led->ConstantLighting(led->_prev_f);
+            ConstantLighting(_prev_f);
             break;
         case CROSSFADE:
-            led->CrossFade(led->_prev_f, led->_prev_s);
+            CrossFade(_prev_f, _prev_s);
             break;
         case BLUEBLINK:
-            led->BlueBlink();
+            BlueBlink();
             break;
         case CALIBRATION:
-            led->Calibration();
+            Calibration();
             break;
         }
-    },
-                                 this);
+    });
 }
 
 void LED::blinkAfter(uint32_t milliseconds)
 {
-    ticker_killer.once_ms<LED *>(milliseconds, [](LED *led) {
-        led->led_ticker.detach();
-        led->CrossFade(led->_prev_f, led->_prev_s, false);
-    },
-                                 this);
+    kill_task.once_ms(milliseconds, [this]() {
+        led_task.detach();
+        CrossFade(_prev_f, _prev_s, false);
+    });
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
  * @author Arseniy Churin
  * @date 2018-05-18
  */
-#include <Ticker.h>
+#include "Scheduler.h"
 
 #ifndef LED_H_
 #define LED_H_
@@ -66,6 +66,14 @@ public:
    * @param Bpin 
    */
   LED(uint8_t Rpin, uint8_t Gpin, uint8_t Bpin);
+
+  /**
+   * @brief Setup pins, LED off
+   * 
+   * Not in the constructor, global objects are built before setup()
+   * 
+   */
+  void begin();
   /**
    * @brief Destroy the LED::LED object
    * 
@@ -193,23 +201,23 @@ private:
   void stateSBlink(RGB col, RGB s_col = NONE);
 
   /**
-   * @brief Detach led_ticker after milliseconds
+   * @brief Detach led_task after milliseconds
    * 
    * @param milliseconds 
    */
   void killAfter(uint32_t milliseconds);
 
   /**
-   * @brief Detach led_ticker after milliseconds and run blink
+   * @brief Detach led_task after milliseconds and run blink
    * 
    * 
    * @param milliseconds 
    */
   void blinkAfter(uint32_t milliseconds);
 
-  Ticker led_ticker;
-  Ticker ticker_killer;
-  Ticker transition_ticker;
+  //UI class, never in front of capture or network
+  Task led_task = Task(TaskUI);
+  Task kill_task = Task(TaskUI);
 
   RGB color = NONE;
   RGB sec_color = NONE;
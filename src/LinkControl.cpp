@@ -0,0 +1,138 @@
+/**
+ * @brief Link quality controller realization
+ *
+ * @file LinkControl.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "LinkControl.h"
+
+#include <Arduino.h>
+
+LinkControl::LinkControl(size_t sampleSize, uint8_t command)
+{
+    _sampleSize = sampleSize < LINK_SAMPLE_LIMIT ? sampleSize : LINK_SAMPLE_LIMIT;
+    _frame[0] = command;
+}
+
+void LinkControl::setBounds(uint8_t maxBatch, uint8_t maxDivider)
+{
+    _maxBatch = constrain(maxBatch, 1, LINK_BATCH_LIMIT);
+    _maxDivider = maxDivider ? maxDivider : 1;
+
+    if (_batch > _maxBatch)
+        _batch = _maxBatch;
+    if (_divider > _maxDivider)
+        _divider = _maxDivider;
+    if (_count >= _batch)
+        _count = 0;
+}
+
+void LinkControl::setSequence(bool enable)
+{
+    uint8_t header = enable ? LINK_HEADER_SIZE : 1;
+    if (header == _header)
+        return;
+    _header = header;
+    _count = 0;
+}
+
+bool LinkControl::add(const uint8_t *sample)
+{
+    //Every sample counts, the step between sent samples is the divider
+    uint32_t seq = _seq++;
+    if (++_skip < _divider)
+        return false;
+    _skip = 0;
+
+    if (_count >= _batch)
+        _count = 0;
+
+    if (_count == 0 && _header != 1)
+        memcpy(&_frame[1], &seq, sizeof(seq));
+
+    memcpy(&_frame[_header + _count * _sampleSize], sample, _sampleSize);
+    return ++_count == _batch;
+}
+
+void LinkControl::written(uint32_t us)
+{
+    if (_writeCount == 0xFFFF)
+        return;
+    _writeSum += us;
+    _writeCount++;
+}
+
+bool LinkControl::update(const LinkSample &link)
+{
+    uint32_t dropped = link.dropped - _dropped;
+    _dropped = link.dropped;
+
+    _lastWrite = _writeCount ? min(_writeSum / _writeCount, (uint32_t)0xFFFF) : 0;
+    _writeSum = 0;
+    _writeCount = 0;
+
+    //Frames pile up or get lost: fewer, bigger frames
+    bool congested = dropped > 0 ||
+                     link.queueAge > LINK_QUEUE_SLOW ||
+                     _lastWrite > LINK_WRITE_SLOW;
+
+    if (congested || link.rssi < LINK_RSSI_WEAK)
+    {
+        _good = 0;
+        return degrade();
+    }
+
+    if (link.rssi < LINK_RSSI_GOOD || link.queued > 1)
+    {
+        _good = 0;
+        return false;
+    }
+
+    if (++_good < LINK_RECOVER_PERIODS)
+        return false;
+    _good = 0;
+    return restore();
+}
+
+void LinkControl::reset()
+{
+    _count = 0;
+    _skip = 0;
+    _good = 0;
+    _batch = 1;
+    _divider = 1;
+}
+
+bool LinkControl::degrade()
+{
+    if (_batch < _maxBatch)
+    {
+        _batch = min(_batch * 2, (int)_maxBatch);
+        return true;
+    }
+    if (_divider < _maxDivider)
+    {
+        _divider = min(_divider * 2, (int)_maxDivider);
+        return true;
+    }
+    return false;
+}
+
+bool LinkControl::restore()
+{
+    //Rate first, batching only costs latency
+    if (_divider > 1)
+    {
+        _divider /= 2;
+        return true;
+    }
+    if (_batch > 1)
+    {
+        _batch /= 2;
+        if (_count >= _batch)
+            _count = 0;
+        return true;
+    }
+    return false;
+}
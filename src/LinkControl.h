@@ -0,0 +1,150 @@
+/**
+ * @brief Link quality controller
+ *
+ * Picks batch size and sample rate divider from RSSI, send queue and write time
+ * Frame: command, sequence number of the first sample (4 bytes, only if enabled), samples
+ * The sequence number counts every sample offered, also the ones skipped by the divider
+ *
+ * @file LinkControl.h
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#ifndef LINKCONTROL_H
+#define LINKCONTROL_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+//Max samples in one frame and max bytes of one sample (batch buffer size)
+#define LINK_BATCH_LIMIT 8
+#define LINK_SAMPLE_LIMIT 16
+
+//Command byte and sequence number in front of the samples (max)
+#define LINK_HEADER_SIZE 5
+
+//Bounds until the bridge sends its own (batching needs a bridge that parses it)
+#define LINK_DEFAULT_MAX_BATCH 1
+#define LINK_DEFAULT_MAX_DIVIDER 4
+
+//Evaluation period (ms) and good periods in a row before one step back
+#define LINK_PERIOD 500
+#define LINK_RECOVER_PERIODS 4
+
+//Link is bad below / good above (dBm)
+#define LINK_RSSI_WEAK -80
+#define LINK_RSSI_GOOD -72
+
+//Average write time (us) and oldest queued frame (ms) of a congested link
+#define LINK_WRITE_SLOW 2000
+#define LINK_QUEUE_SLOW 40
+
+/**
+ * @brief Link measurements of one period
+ */
+struct LinkSample
+{
+  int8_t rssi;
+  uint8_t queued;          //frames waiting in the send queue
+  unsigned long queueAge;  //ms the oldest frame waits
+  uint32_t dropped;        //frames dropped by the send queue (total)
+};
+
+class LinkControl
+{
+public:
+  /**
+   * @brief Construct a new Link Control object
+   *
+   * @param sampleSize bytes of one sample (max LINK_SAMPLE_LIMIT)
+   * @param command command byte in front of each frame
+   */
+  LinkControl(size_t sampleSize, uint8_t command);
+
+  /**
+   * @brief Set bounds (from the bridge)
+   *
+   * Operating point is clamped right away
+   *
+   * @param maxBatch 1..LINK_BATCH_LIMIT
+   * @param maxDivider 1..255
+   */
+  void setBounds(uint8_t maxBatch, uint8_t maxDivider);
+
+  /**
+   * @brief Put the sequence number in the frame (bridge parses it)
+   *
+   * Off until the bridge sends its bounds, older bridges expect the samples right after the command
+   * A partial batch is dropped
+   *
+   * @param enable
+   */
+  void setSequence(bool enable);
+
+  /**
+   * @brief Add a sample
+   *
+   * Only every divider-th sample is taken
+   *
+   * @param sample
+   * @return true if a frame is complete, see frame() / length()
+   */
+  bool add(const uint8_t *sample);
+
+  /**
+   * @brief Measure one write, call with the time sendBin took
+   *
+   * @param us
+   */
+  void written(uint32_t us);
+
+  /**
+   * @brief Evaluate the link once per LINK_PERIOD
+   *
+   * Congested: one step down (batch up, then rate down).
+   * Good for LINK_RECOVER_PERIODS: one step back (rate first).
+   *
+   * @param link
+   * @return true if the operating point changed
+   */
+  bool update(const LinkSample &link);
+
+  /**
+   * @brief Drop a partial batch, back to full rate
+   *
+   * The sequence number goes on (one stream across bridge switches)
+   *
+   */
+  void reset();
+
+  const uint8_t *frame() const { return _frame; }
+  size_t length() const { return _header + _count * _sampleSize; }
+
+  uint8_t batch() const { return _batch; }
+  uint8_t divider() const { return _divider; }
+  bool sequence() const { return _header != 1; }
+  uint16_t writeTime() const { return _lastWrite; }
+
+private:
+  bool degrade();
+  bool restore();
+
+  uint8_t _frame[LINK_HEADER_SIZE + LINK_BATCH_LIMIT * LINK_SAMPLE_LIMIT];
+  size_t _sampleSize;
+  uint8_t _header = 1;
+  uint8_t _count = 0;
+  uint8_t _skip = 0;
+  uint32_t _seq = 0;
+
+  uint8_t _batch = 1;
+  uint8_t _divider = 1;
+  uint8_t _maxBatch = LINK_DEFAULT_MAX_BATCH;
+  uint8_t _maxDivider = LINK_DEFAULT_MAX_DIVIDER;
+
+  uint8_t _good = 0;
+  uint32_t _dropped = 0;
+  uint32_t _writeSum = 0;
+  uint16_t _writeCount = 0;
+  uint16_t _lastWrite = 0;
+};
+
+#endif
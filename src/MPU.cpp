@@ -62,11 +62,14 @@ void MPU::enable()
     _mpu.setSleepEnabled(false);
 }
 
-void MPU::mpu_setup()
+void MPU::bus_setup()
 {
     Wire.begin();
     Wire.setClock(400000); // 400kHz I2C clock. Comment this line if having compilation difficulties
+}
 
+void MPU::mpu_setup()
+{
     // initialize device
     Serial.println(F("Initializing I2C devices..."));
     _mpu.initialize();
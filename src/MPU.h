@@ -21,6 +21,10 @@ public:
    */
   static MPU &Instance();
 
+  /**
+   * @brief Setup of I2C bus, before mpu_setup()
+   */
+  void bus_setup();
   /**
    * @brief Setup of MPU
    */
@@ -0,0 +1,64 @@
+/**
+ * @brief States, events and transition table of the node realization
+ *
+ * @file NodeFsm.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "NodeFsm.h"
+
+static NodeActions actions = {};
+
+void nodeActions(const NodeActions &injected)
+{
+    actions = injected;
+}
+
+//The tables are const, they call through the injected actions
+static void run(FsmAction action)
+{
+    if (action)
+        action();
+}
+
+static void blueBlink() { run(actions.blueBlink); }
+static void crossFade() { run(actions.crossFade); }
+static void ledCalibration() { run(actions.ledCalibration); }
+static void exitBind() { run(actions.exitBind); }
+static void exitSearch() { run(actions.exitSearch); }
+static void startStream() { run(actions.startStream); }
+static void enterActive() { run(actions.enterActive); }
+static void exitActive() { run(actions.exitActive); }
+
+/**
+ * @brief States (indexed by State)
+ * 
+ * data is the radio profile
+ */
+const FsmStateDef node_states[NodeStates] = {
+    //name          enter        exit        radio
+    {"Undef",       NULL,        NULL,       RadioModemSleep},
+    {"Bind",        NULL,        exitBind,   RadioNoSleep},
+    {"Calibration", NULL,        NULL,       RadioModemSleep},
+    {"Standby",     NULL,        NULL,       RadioLightSleep},
+    {"Active",      enterActive, exitActive, RadioNoSleep},
+    {"Search",      NULL,        exitSearch, RadioLightSleep}};
+
+/**
+ * @brief Transitions, first matching row wins
+ * 
+ */
+const FsmTransition node_transitions[] = {
+    //from        event         to           guard  action
+    {Undef,       EvBind,       Bind,        NULL,  crossFade},
+    {Search,      EvBind,       Bind,        NULL,  crossFade},
+    {Undef,       EvSearch,     Search,      NULL,  NULL},
+    {Undef,       EvDisconnect, Search,      NULL,  NULL},
+    {Search,      EvDisconnect, Search,      NULL,  NULL},
+    {FSM_ANY,     EvDisconnect, Search,      NULL,  blueBlink},
+    {FSM_ANY,     EvConnect,    Standby,     NULL,  crossFade},
+    {FSM_ANY,     EvStop,       Standby,     NULL,  NULL},
+    {Standby,     EvStart,      Active,      NULL,  startStream},
+    {Standby,     EvCalibrate,  Calibration, NULL,  ledCalibration}};
+
+const uint8_t node_transition_count = sizeof(node_transitions) / sizeof(node_transitions[0]);
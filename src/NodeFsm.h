@@ -0,0 +1,76 @@
+/**
+ * @brief States, events and transition table of the node
+ *
+ * The tables of the firmware, actions are injected (LED, vibration, stream),
+ * so the real rows run on the host as well. No Arduino dependency.
+ *
+ * @file NodeFsm.h
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#ifndef NODEFSM_H
+#define NODEFSM_H
+
+#include "Fsm.h"
+
+typedef enum
+{
+  Undef,
+  Bind,
+  Calibration,
+  Standby,
+  Active,
+  Search,
+  NodeStates
+} State;
+
+typedef enum
+{
+  EvSearch,
+  EvBind,
+  EvConnect,
+  EvDisconnect,
+  EvStart,
+  EvStop,
+  EvCalibrate
+} StateEvent;
+
+/**
+ * @brief Radio profile of a state (FsmStateDef::data)
+ *
+ * No sleep while streaming (no DTIM latency), light sleep while waiting
+ */
+typedef enum
+{
+  RadioNoSleep,
+  RadioLightSleep,
+  RadioModemSleep
+} RadioProfile;
+
+/**
+ * @brief Actions of the tables, NULL = nothing to do
+ */
+struct NodeActions
+{
+  FsmAction blueBlink;
+  FsmAction crossFade;
+  FsmAction ledCalibration;
+  FsmAction exitBind;
+  FsmAction exitSearch;
+  FsmAction startStream;
+  FsmAction enterActive;
+  FsmAction exitActive;
+};
+
+extern const FsmStateDef node_states[NodeStates];
+extern const FsmTransition node_transitions[];
+extern const uint8_t node_transition_count;
+
+/**
+ * @brief Set the actions called by the tables
+ *
+ * @param actions copied
+ */
+void nodeActions(const NodeActions &actions);
+
+#endif
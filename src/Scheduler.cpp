@@ -0,0 +1,143 @@
+/**
+ * @brief Cooperative scheduler realization
+ *
+ * @file Scheduler.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "Scheduler.h"
+
+#include <Arduino.h>
+
+static const uint32_t deadlines[TaskClasses] = {SCHED_CAPTURE_DEADLINE, SCHED_NETWORK_DEADLINE, SCHED_UI_DEADLINE};
+
+Task::Task(TaskClass cls, uint32_t deadline)
+{
+    _cls = cls;
+    _deadline = deadline ? deadline : deadlines[cls];
+}
+
+Task::~Task()
+{
+    if (_linked)
+        Scheduler::Instance().remove(this);
+}
+
+void Task::attach_ms(uint32_t milliseconds, TaskCallback callback)
+{
+    arm(milliseconds, true, callback);
+}
+
+void Task::once_ms(uint32_t milliseconds, TaskCallback callback)
+{
+    arm(milliseconds, false, callback);
+}
+
+void Task::arm(uint32_t milliseconds, bool repeat, TaskCallback callback)
+{
+    Scheduler &scheduler = Scheduler::Instance();
+    if (!_linked)
+        scheduler.add(this);
+
+    //Longer would overflow or look overdue to the signed compare
+    if (milliseconds > SCHED_MAX_INTERVAL)
+        milliseconds = SCHED_MAX_INTERVAL;
+
+    _callback = callback;
+    _interval = milliseconds * 1000;
+    _due = micros() + _interval;
+    _repeat = repeat;
+    //Not again in the running pass if armed from a task
+    _pass = scheduler._pass;
+    _active = true;
+}
+
+Scheduler &Scheduler::Instance()
+{
+    static Scheduler s;
+    return s;
+}
+
+void Scheduler::add(Task *task)
+{
+    task->_next = _tasks;
+    _tasks = task;
+    task->_linked = true;
+}
+
+void Scheduler::remove(Task *task)
+{
+    for (Task **t = &_tasks; *t; t = &(*t)->_next)
+    {
+        if (*t == task)
+        {
+            *t = task->_next;
+            task->_linked = false;
+            return;
+        }
+    }
+}
+
+Task *Scheduler::next(uint32_t now) const
+{
+    Task *best = NULL;
+    for (Task *t = _tasks; t; t = t->_next)
+    {
+        if (!t->_active || t->_pass == _pass || (int32_t)(now - t->_due) < 0)
+            continue;
+        if (!best || t->_cls < best->_cls ||
+            (t->_cls == best->_cls && (int32_t)(t->_due - best->_due) < 0))
+            best = t;
+    }
+    return best;
+}
+
+void Scheduler::run()
+{
+    uint32_t start = micros();
+    _pass++;
+
+    Task *task;
+    while ((task = next(micros())) != NULL)
+    {
+        uint32_t now = micros();
+        if (task->_cls == TaskUI && now - start > SCHED_UI_SLICE)
+            break;
+
+        uint32_t late = now - task->_due;
+        TaskStats &stats = _stats[task->_cls];
+        stats.runs++;
+        if (late > task->_deadline)
+            stats.overruns++;
+        if (late > stats.maxLate)
+            stats.maxLate = late;
+
+        task->_pass = _pass;
+        if (task->_repeat)
+        {
+            //Keep the phase, skip periods that are already missed
+            task->_due += task->_interval;
+            if ((int32_t)(now - task->_due) >= 0)
+                task->_due = now + task->_interval;
+            //Callback may arm the task again or destroy it, run a copy
+            TaskCallback callback = task->_callback;
+            callback();
+        }
+        else
+        {
+            //Callback may arm the task again
+            task->_active = false;
+            TaskCallback callback = std::move(task->_callback);
+            callback();
+        }
+
+        uint32_t run = micros() - now;
+        if (run > stats.maxRun)
+            stats.maxRun = run;
+    }
+}
+
+void Scheduler::resetStats()
+{
+    memset(_stats, 0, sizeof(_stats));
+}
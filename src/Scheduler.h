@@ -0,0 +1,158 @@
+/**
+ * @brief Cooperative scheduler with priority classes
+ *
+ * Tasks run from loop() (not from the timer context like Ticker),
+ * highest class first: capture, network, UI. Each task runs at most once
+ * per pass and the highest class due is picked again after every task,
+ * so a sample is never behind an LED fade. UI tasks stop when the pass
+ * is over SCHED_UI_SLICE.
+ *
+ * Lateness (start - due) over the deadline of the task is an overrun,
+ * counted per class.
+ *
+ * @file Scheduler.h
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <functional>
+
+//Default deadlines of the classes (us)
+#define SCHED_CAPTURE_DEADLINE 5000
+#define SCHED_NETWORK_DEADLINE 20000
+#define SCHED_UI_DEADLINE 50000
+
+//UI tasks are not started after this time in one pass (us)
+#define SCHED_UI_SLICE 2000
+
+//Longest interval (ms): due times are compared as signed 32 bit us,
+//so an interval has to stay below 2^31 us (about 35 min)
+#define SCHED_MAX_INTERVAL 2147483UL
+
+/**
+ * @brief Priority classes, lower runs first
+ */
+typedef enum
+{
+  TaskCapture,
+  TaskNetwork,
+  TaskUI,
+  TaskClasses
+} TaskClass;
+
+typedef std::function<void()> TaskCallback;
+
+/**
+ * @brief Accounting of one class
+ */
+struct TaskStats
+{
+  uint32_t runs;
+  uint32_t overruns; //started later than the deadline
+  uint32_t maxLate;  //us
+  uint32_t maxRun;   //us
+};
+
+class Scheduler;
+
+/**
+ * @brief Periodic or one shot task, Ticker like interface
+ */
+class Task
+{
+public:
+  /**
+   * @brief Construct a new Task object
+   *
+   * @param cls priority class
+   * @param deadline max lateness (us), 0 = default of the class
+   */
+  Task(TaskClass cls, uint32_t deadline = 0);
+  ~Task();
+
+  /**
+   * @brief Run every milliseconds, first run after one period
+   *
+   * 0 = every pass
+   *
+   * @param milliseconds clamped to SCHED_MAX_INTERVAL
+   * @param callback
+   */
+  void attach_ms(uint32_t milliseconds, TaskCallback callback);
+
+  /**
+   * @brief Run once after milliseconds
+   *
+   * @param milliseconds clamped to SCHED_MAX_INTERVAL
+   * @param callback
+   */
+  void once_ms(uint32_t milliseconds, TaskCallback callback);
+
+  void detach() { _active = false; }
+  bool active() const { return _active; }
+
+private:
+  friend class Scheduler;
+
+  void arm(uint32_t milliseconds, bool repeat, TaskCallback callback);
+
+  TaskClass _cls;
+  uint32_t _deadline;
+  uint32_t _interval = 0; //us
+  uint32_t _due = 0;
+  uint32_t _pass = 0;
+  bool _active = false;
+  bool _repeat = false;
+  bool _linked = false;
+  TaskCallback _callback;
+  Task *_next = NULL;
+};
+
+class Scheduler
+{
+public:
+  /**
+   * @brief Return instance of singleton class
+   *
+   * @return Scheduler&
+   */
+  static Scheduler &Instance();
+
+  /**
+   * @brief One pass, call from loop()
+   *
+   * Due tasks in class order, the class order is checked again after every task
+   * Also from blocking waits outside of loop(), never from a task.
+   * Tasks stand still while the caller blocks without it (MPU / DMP setup).
+   */
+  void run();
+
+  /**
+   * @brief Accounting of a class since the last reset
+   *
+   * @param cls
+   */
+  const TaskStats &stats(TaskClass cls) const { return _stats[cls]; }
+  void resetStats();
+
+private:
+  friend class Task;
+
+  Scheduler() {}
+  Scheduler(Scheduler const &) = delete;
+  Scheduler &operator=(Scheduler const &) = delete;
+
+  void add(Task *task);
+  void remove(Task *task);
+  Task *next(uint32_t now) const;
+
+  Task *_tasks = NULL;
+  uint32_t _pass = 0;
+  TaskStats _stats[TaskClasses] = {};
+};
+
+#endif
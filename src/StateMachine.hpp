@@ -18,209 +18,358 @@
 #include "WebClient.h"
 #include "Vibro.h"
 #include "EEPROM.hpp"
+#include "LinkControl.h"
+#include "NodeFsm.h"
+#include "Scheduler.h"
+#include "Histogram.h"
 
 #include <Arduino.h>
 
-#include <Ticker.h>
+/**
+ * @brief Setup phases, timed in state_setup (us)
+ * 
+ */
+typedef enum
+{
+  PhaseEeprom,
+  PhaseIO,
+  PhaseWiFi,
+  PhaseBus,
+  PhaseMpu,
+  PhaseBind,
+  BootPhases
+} BootPhase;
+
+/**
+ * @brief Boot milestones, time since reset (ms), 0 = not reached yet
+ * 
+ */
+typedef enum
+{
+  BootSetup,
+  BootWire,
+  BootDmp,
+  BootWiFi,
+  BootWS,
+  BootSample,
+  BootMilestones
+} BootMilestone;
+
+const char *boot_phase_names[BootPhases] = {"eeprom", "io", "wifi", "bus", "mpu", "bind"};
+const char *boot_milestone_names[BootMilestones] = {"setup", "wire", "dmp", "wifi", "ws", "sample"};
+
+uint32_t boot_phases[BootPhases];
+uint32_t boot_milestones[BootMilestones];
+bool boot_reported = false;
+WiFiEventHandler boot_ip_handler;
 
+/**
+ * @brief Profiled stages, cycles per run
+ * 
+ */
 typedef enum
 {
-  Undef,
-  Bind,
-  Calibration,
-  Standby,
-  Active,
-  Search
-} State;
+  StageLoop,
+  StageWs,
+  StageMpu,
+  StageSend,
+  Stages
+} ProfileStage;
 
+const char *stage_names[Stages] = {"loop", "ws", "mpu", "send"};
+
+Histogram stage_hist[Stages];
+
+//Objects only store their settings, hardware is set up by state_setup
 LED led = LED(13, 12, 14);
 uint16_t mem_colors[6];
 
-WebClient wc = WebClient(ReadString(10));
+WebClient wc;
 
 MPU &mpu = MPU::Instance();
 Vibro vibr = Vibro(2);
-State _state = Undef;
 
-Ticker restart_ticker;
+Scheduler &scheduler = Scheduler::Instance();
+
+//IMU capture first, then network, UI effects (LED, Vibro) last
+Task capture_task = Task(TaskCapture);
+Task ws_task = Task(TaskNetwork);
+Task link_task = Task(TaskNetwork);
+Task restart_task = Task(TaskNetwork);
+
+uint8_t quat[4 * sizeof(float)];
 
-uint8_t *quat = new uint8_t[4 * sizeof(float)];
+LinkControl link = LinkControl(4 * sizeof(float), MPU_DATA);
 
 /**
- * @brief Set the State of StateMachine
+ * @brief Record a milestone, only the first time
  * 
- * @param state 
-*/
-void setState(State state)
+ * @param milestone 
+ */
+void bootMilestone(BootMilestone milestone)
 {
-  if (state == _state)
-    return;
-
-  switch (_state)
-  {
-  case Undef:
-    Serial.println("Exit from Undef state");
-    // state Undef exit logic
-    break;
-  case Bind:
-    Serial.println("Exit from Bind state");
-    wc.onBind(nullptr);
-    break;
-  case Calibration:
-    Serial.println("Exit from Calibration state");
-    // state Calibration exit logic
-    break;
-  case Standby:
-    Serial.println("Exit from Standby state");
-    // state Standby exit logic
-    break;
-  case Active:
-    Serial.println("Exit from Active state");
-    //MPU_ticker.detach();
-    mpu.disable();
-    break;
-  case Search:
-    Serial.println("Exit from Search state");
-    vibr.SingleVibration();
-    // state Searching exit logic
-    break;
-  }
-  _state = state;
+  if (!boot_milestones[milestone])
+    boot_milestones[milestone] = millis();
 }
 
 /**
- * @brief Switch state machine to Undef state
+ * @brief Record duration of a setup phase, next phase starts now
  * 
+ * @param phase 
+ * @param start start of the phase (us), set to now
  */
-void stateUndef()
+void bootPhase(BootPhase phase, uint32_t &start)
 {
-  setState(Undef);
-  Serial.println("Switch to Undef state");
-  // State Undef enter logic
+  uint32_t now = micros();
+  boot_phases[phase] = now - start;
+  start = now;
 }
 
 /**
- * @brief Switch state machine to Search state
+ * @brief Report boot timings
  * 
+ * phase count, phase durations (us, 4 bytes each),
+ * milestone count, milestones (ms since reset, 4 bytes each)
  */
-void stateSearch()
+void sendBootReport()
 {
-  if (_state != Undef)
-    led.BlueBlink();
-  setState(Search);
-  Serial.println("Switch to Search state");
+  uint8_t buf[2 + sizeof(boot_phases) + sizeof(boot_milestones)];
+  buf[0] = BootPhases;
+  memcpy(buf + 1, boot_phases, sizeof(boot_phases));
+  buf[1 + sizeof(boot_phases)] = BootMilestones;
+  memcpy(buf + 2 + sizeof(boot_phases), boot_milestones, sizeof(boot_milestones));
+  wc.sendBin(buf, sizeof(buf), BOOT_REPORT);
 }
 
 /**
- * @brief Switch state machine to Bind state
+ * @brief Print boot timings, send them once the first sample is out
  * 
  */
-void stateBind()
+void bootReport()
 {
-  if (_state != Undef && _state != Search)
-    return;
+  boot_reported = true;
 
-  led.CrossFade(mem_colors);
+  for (int i = 0; i < BootPhases; ++i)
+    Serial.printf("Boot phase %s: %u us\n", boot_phase_names[i], boot_phases[i]);
+  for (int i = 0; i < BootMilestones; ++i)
+    Serial.printf("Boot %s at %u ms\n", boot_milestone_names[i], boot_milestones[i]);
 
-  setState(Bind);
-  Serial.println("Switch to Bind state");
+  sendBootReport();
 }
 
 /**
- * @brief Switch state machine to Calibration state
+ * @brief Report operating point of the link controller
  * 
+ * batch, rate divider, RSSI, frames queued, average write time (us, 2 bytes),
+ * WiFi sleep type
  */
-void stateCalibration()
+void sendLinkState()
 {
-  if (_state != Standby)
-    return;
-
-  led.Calibration();
+  WSqueueStats_t queue = wc.sendQueueStats();
+  uint16_t write = link.writeTime();
+  uint8_t buf[7];
+  buf[0] = link.batch();
+  buf[1] = link.divider();
+  buf[2] = (int8_t)WiFi.RSSI();
+  buf[3] = queue.entries;
+  memcpy(buf + 4, &write, sizeof(write));
+  buf[6] = WiFi.getSleepMode();
+  wc.sendBin(buf, sizeof(buf), LINK_STATE);
+}
 
-  setState(Calibration);
-  Serial.println("Switch to Calibration state");
+/**
+ * @brief Report scheduler accounting since the last report
+ * 
+ * class count, per class: runs, overruns, max lateness (us), max run time (us)
+ */
+void sendSchedStats()
+{
+  uint8_t buf[1 + TaskClasses * sizeof(TaskStats)];
+  buf[0] = TaskClasses;
+  for (int i = 0; i < TaskClasses; ++i)
+    memcpy(buf + 1 + i * sizeof(TaskStats), &scheduler.stats((TaskClass)i), sizeof(TaskStats));
+  wc.sendBin(buf, sizeof(buf), SCHED_STATS);
+  scheduler.resetStats();
 }
 
 /**
- * @brief Switch state machine to Standby state
+ * @brief Report stage histograms since the last report, print them as well
  * 
+ * stage count, bucket count, first bucket shift, CPU MHz,
+ * per stage: count, max (cycles), buckets (2 bytes each)
  */
-void stateStandby()
+void sendProfile()
 {
-  setState(Standby);
-  Serial.println("Switch to Standby state");
+  uint8_t buf[4 + Stages * HIST_SIZE];
+  buf[0] = Stages;
+  buf[1] = HIST_BUCKETS;
+  buf[2] = HIST_FIRST_SHIFT;
+  buf[3] = ESP.getCpuFreqMHz();
+  for (int i = 0; i < Stages; ++i)
+  {
+    stage_hist[i].write(buf + 4 + i * HIST_SIZE);
+    stage_hist[i].dump(stage_names[i], [](const char *line) { Serial.print(line); });
+  }
+  wc.sendBin(buf, sizeof(buf), STAGE_PROFILE);
+
+  for (int i = 0; i < Stages; ++i)
+    stage_hist[i].reset();
 }
 
 /**
- * @brief Switch state machine to Active state
+ * @brief Capture task, every pass while Active
  * 
  */
-void stateActive()
+void capture()
 {
-  if (_state != Standby)
+  //Frame is complete after batch samples, the command byte is already in it
+  uint32_t cycles = ESP.getCycleCount();
+  bool sample = mpu.mpu_loop(quat);
+  stage_hist[StageMpu].add(ESP.getCycleCount() - cycles);
+
+  if (!sample || !link.add(quat))
     return;
-  setState(Active);
-  Serial.println("Switch to Active state");
-  mpu.enable();
-  // #ifdef DEV_MODE
-  //   MPU_ticker.attach_ms(50, []() {
-  //     uint8_t *quat = (uint8_t *)"0000000000000000";
-  //     wc.sendBin(quat, 4 * sizeof(float), MPU_DATA);
-  //   });
-  // #else
-  //   MPU_ticker.attach_ms(50, []() {
-  //     mpu.mpu_loop(quat);
-  //     if (quat)
-  //       wc.sendBin(quat, 4 * sizeof(float), MPU_DATA);
-  //   });
-  // #endif
+
+  uint32_t start = micros();
+  cycles = ESP.getCycleCount();
+  wc.sendBin((uint8_t *)link.frame(), link.length());
+  stage_hist[StageSend].add(ESP.getCycleCount() - cycles);
+  link.written(micros() - start);
+
+  if (!boot_reported)
+  {
+    bootMilestone(BootSample);
+    bootReport();
+  }
 }
 
 /**
- * @brief On ws connect
+ * @brief Link task, every LINK_PERIOD while Active
  * 
  */
-void connect()
+void linkUpdate()
+{
+  WSqueueStats_t queue = wc.sendQueueStats();
+  LinkSample sample = {(int8_t)WiFi.RSSI(), queue.entries, queue.oldestAge, queue.dropped};
+  if (link.update(sample))
+    sendLinkState();
+}
+
+/**
+ * @brief Entry / exit and transition actions
+ * 
+ */
+void blueBlink()
+{
+  led.BlueBlink();
+}
+
+void crossFade()
 {
-  Serial.println("Connected!");
   led.CrossFade(mem_colors);
-  stateStandby();
 }
 
+void ledCalibration()
+{
+  led.Calibration();
+}
+
+void exitBind()
+{
+  wc.onBind(nullptr);
+}
+
+void exitSearch()
+{
+  vibr.SingleVibration();
+}
+
+void startStream()
+{
+  link.reset();
+  link_task.attach_ms(LINK_PERIOD, linkUpdate);
+}
+
+void enterActive()
+{
+  mpu.enable();
+  capture_task.attach_ms(0, capture);
+}
+
+void exitActive()
+{
+  capture_task.detach();
+  link_task.detach();
+  mpu.disable();
+}
+
+uint32_t fsmClock()
+{
+  return micros();
+}
+
+Fsm fsm = Fsm(node_states, NodeStates, node_transitions, node_transition_count,
+              Undef, fsmClock);
+
+//Actions of the node tables (NodeFsm.cpp)
+const NodeActions node_actions = {blueBlink, crossFade, ledCalibration, exitBind,
+                                  exitSearch, startStream, enterActive, exitActive};
+
+//WiFi sleep type of a RadioProfile
+const WiFiSleepType_t radio_sleep[] = {WIFI_NONE_SLEEP, WIFI_LIGHT_SLEEP, WIFI_MODEM_SLEEP};
+
 /**
- * @brief On ws disconnect
+ * @brief Log transition, apply radio profile of the new state
  * 
+ * The profile is reported to see the latency / power trade-off
+ * 
+ * @param trace 
  */
-void disconnect()
+void onTransition(const FsmTrace &trace)
 {
-  Serial.println("Disconnected((");
-  if (_state != Search)
-    stateSearch();
+  Serial.printf("State %s -> %s (event %u) at %u us in %u us\n",
+                fsm.name(trace.from), fsm.name(trace.to), trace.event, trace.at, trace.duration);
+
+  WiFiSleepType_t sleep = radio_sleep[fsm.def().data];
+  if (WiFi.getSleepMode() != sleep)
+  {
+    WiFi.setSleepMode(sleep);
+    if (trace.to != Search && trace.to != Undef)
+      sendLinkState();
+  }
 }
 
 /**
  * @brief Led on with color
  * 
- * @param f First color
- * @param s Second color 
+ * @param rgb First and optional second color, 8 bit values from the receive buffer
  */
-void changeColor(uint16_t (&c)[6])
+void changeColor(const PayloadView &rgb)
 {
-  if (_state != Standby && _state != Bind)
+  if (fsm.state() != Standby && fsm.state() != Bind)
     return;
 
-  if (CompareArrays(c, mem_colors, color_size * 2))
+  bool changed = false;
+  for (int i = 0; i < color_size * 2; ++i)
+  {
+    uint16_t v = rgb.at(i) * 4;
+    if (mem_colors[i] != v)
+    {
+      mem_colors[i] = v;
+      changed = true;
+    }
+  }
+
+  if (!changed)
     return;
 
-  WriteRGB(c, COLOR_ADDRESS);
-  for (int i = 0; i < color_size * 2; ++i)
-    mem_colors[i] = c[i];
-  led.CrossFade(c);
+  WriteRGB(mem_colors, COLOR_ADDRESS);
+  led.CrossFade(mem_colors);
 }
 
 void sendColor()
 {
-  if (_state != Standby && _state != Bind)
+  if (fsm.state() != Standby && fsm.state() != Bind)
     return;
 
   uint8_t colors[6];
@@ -249,22 +398,41 @@ void Alarm()
   vibr.AlarmVibration();
 }
 
-void changeSSID(String ssid)
+void changeSSID(const String &ssid)
 {
-  if (_state != Bind)
+  if (fsm.state() != Bind)
     return;
   SaveString(10, (uint8_t *)ssid.c_str(), ssid.length());
 }
 
+void saveJoin(const JoinInfo &join)
+{
+  SaveBytes(JOIN_ADDRESS, (const uint8_t *)&join, sizeof(JoinInfo));
+}
+
+void saveBridges(const BridgeList &bridges)
+{
+  SaveBytes(BRIDGES_ADDRESS, (const uint8_t *)&bridges, sizeof(BridgeList));
+}
+
+void linkBounds(const PayloadView &args)
+{
+  //A bridge that sends bounds also parses the sequence number
+  link.setBounds(args.at(0, 1), args.at(1, 1));
+  link.setSequence(true);
+  if (fsm.state() == Active)
+    sendLinkState();
+}
+
 void Restart(uint16_t seconds)
 {
-  if (_state != Standby)
+  if (fsm.state() != Standby)
     return;
 
   if (seconds > 10)
     seconds = 10;
 
-  restart_ticker.attach(seconds, []() { ESP.restart(); });
+  restart_task.once_ms(seconds * 1000, []() { ESP.restart(); });
 }
 
 /**
@@ -273,14 +441,36 @@ void Restart(uint16_t seconds)
  */
 void state_setup()
 {
+  bootMilestone(BootSetup);
+  uint32_t start = micros();
+
+  String bridge_id = ReadString(10);
+  ReadRGB(mem_colors, COLOR_ADDRESS);
+  JoinInfo join;
+  bool join_valid = ReadBytes(JOIN_ADDRESS, (uint8_t *)&join, sizeof(JoinInfo));
+  BridgeList bridges;
+  bool bridges_valid = ReadBytes(BRIDGES_ADDRESS, (uint8_t *)&bridges, sizeof(BridgeList));
+  bootPhase(PhaseEeprom, start);
+
+  led.begin();
+  vibr.begin();
   led.BlueBlink();
-  wc.onConnect(connect);
-  wc.onDisconnect(disconnect);
-  wc.onStart(stateActive);
-  wc.onStop(stateStandby);
-  wc.onBind(stateBind);
+  bootPhase(PhaseIO, start);
+
+  wc.begin(bridge_id);
+  boot_ip_handler = WiFi.onStationModeGotIP([](const WiFiEventStationModeGotIP &) { bootMilestone(BootWiFi); });
+  nodeActions(node_actions);
+  fsm.onTransition(onTransition);
+  wc.onConnect([]() {
+    bootMilestone(BootWS);
+    fsm.dispatch(EvConnect);
+  });
+  wc.onDisconnect([]() { fsm.dispatch(EvDisconnect); });
+  wc.onStart([]() { fsm.dispatch(EvStart); });
+  wc.onStop([]() { fsm.dispatch(EvStop); });
+  wc.onBind([]() { fsm.dispatch(EvBind); });
   wc.onSSID(changeSSID);
-  wc.onCalibirate(stateCalibration);
+  wc.onCalibirate([]() { fsm.dispatch(EvCalibrate); });
   wc.onColor(changeColor);
   wc.onGetColor(sendColor);
   wc.onLedIO(setLedIO);
@@ -289,22 +479,49 @@ void state_setup()
   wc.onVibro(vibroResponse);
   wc.onAlarm(Alarm);
   wc.onRestart(Restart);
-
+  wc.onLinkBounds(linkBounds);
+  wc.onBootReport(sendBootReport);
+  wc.onSchedStats(sendSchedStats);
+  wc.onProfile(sendProfile);
+  wc.onJoin(saveJoin);
+  wc.onBridges(saveBridges);
+
+  if (join_valid)
+    wc.setJoin(join);
+  if (bridges_valid)
+    wc.setBridges(bridges);
+
+  //Bind scan runs in background while the MPU is set up
+  wc.scan_start();
   delay(1);
-  ReadRGB(mem_colors, COLOR_ADDRESS);
+  bootPhase(PhaseWiFi, start);
 
   //#ifndef DEV_MODE
+  //Blocks, the scheduler does not run: the blue blink stands still until the DMP is loaded
+  mpu.bus_setup();
+  bootMilestone(BootWire);
+  bootPhase(PhaseBus, start);
+
   mpu.mpu_setup();
   mpu.disable();
+  bootMilestone(BootDmp);
+  bootPhase(PhaseMpu, start);
   //#endif
 
   if (wc.bind_connection())
-    stateBind();
+    fsm.dispatch(EvBind);
   else
   {
-    stateSearch();
+    fsm.dispatch(EvSearch);
     wc.connect();
   }
+  bootPhase(PhaseBind, start);
+
+  ws_task.attach_ms(0, []() {
+    uint32_t cycles = ESP.getCycleCount();
+    wc.loop();
+    stage_hist[StageWs].add(ESP.getCycleCount() - cycles);
+  });
 }
 
 /**
@@ -313,11 +530,9 @@ void state_setup()
  */
 void state_loop()
 {
-  wc.loop();
-
-  if (_state == Active)
-    if (mpu.mpu_loop(quat))
-      wc.sendBin(quat, 4 * sizeof(float), MPU_DATA);
+  uint32_t cycles = ESP.getCycleCount();
+  scheduler.run();
+  stage_hist[StageLoop].add(ESP.getCycleCount() - cycles);
 };
 
 #endif
\ No newline at end of file
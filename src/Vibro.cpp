@@ -8,41 +8,42 @@
 #include "Vibro.h"
 
 #include <Arduino.h>
-#include <Ticker.h>
 
 Vibro::Vibro(uint8_t pin)
 {
     _pin = pin;
-    pinMode(pin, OUTPUT);
-    digitalWrite(pin, HIGH);
+}
+
+void Vibro::begin()
+{
+    pinMode(_pin, OUTPUT);
+    digitalWrite(_pin, HIGH);
 }
 
 void Vibro::AlarmVibration()
 {
-    vibro_ticker.attach_ms<Vibro *>(500, [](Vibro *v) {
-        if (v->tumbler)
-            v->on();
+    vibro_task.attach_ms(500, [this]() {
+        if (tumbler)
+            on();
         else
-            v->off();
+            off();
 
-        v->tumbler = !v->tumbler;
-    },
-                                    this);
+        tumbler = !tumbler;
+    });
 
     killAfter(3000);
 }
 
 void Vibro::DoneVibration()
 {
-    vibro_ticker.attach_ms<Vibro *>(150, [](Vibro *v) {
-        if (v->tumbler)
-            v->on();
+    vibro_task.attach_ms(150, [this]() {
+        if (tumbler)
+            on();
         else
-            v->off();
+            off();
 
-        v->tumbler = !v->tumbler;
-    },
-                                    this);
+        tumbler = !tumbler;
+    });
 
     killAfter(600);
 }
@@ -50,10 +51,9 @@ void Vibro::DoneVibration()
 void Vibro::SingleVibration(uint16_t milliseconds, uint16_t power)
 {
     on(power);
-    vibro_ticker.attach_ms<Vibro *>(milliseconds, [](Vibro *v) {
-        v->off();
-    },
-                                    this);
+    vibro_task.once_ms(milliseconds, [this]() {
+        off();
+    });
 }
 
 void Vibro::on(uint16_t power)
@@ -68,10 +68,9 @@ void Vibro::off()
 
 void Vibro::killAfter(uint32_t milliseconds)
 {
-    ticker_killer.once_ms<Vibro *>(milliseconds, [](Vibro *v) {
-        v->vibro_ticker.detach();
-        v->off();
-        v->tumbler = true;
-    },
-                                   this);
+    kill_task.once_ms(milliseconds, [this]() {
+        vibro_task.detach();
+        off();
+        tumbler = true;
+    });
 }
\ No newline at end of file
@@ -9,7 +9,7 @@
 #define VIBRO_H
 
 #include <inttypes.h>
-#include <Ticker.h>
+#include "Scheduler.h"
 
 class Vibro
 {
@@ -21,6 +21,12 @@ public:
    */
   Vibro(uint8_t pin);
 
+  /**
+   * @brief Setup pin, motor off
+   * 
+   */
+  void begin();
+
   /**
    * @brief Method to do alarm AlarmVibration
    * 
@@ -52,14 +58,14 @@ private:
    */
   void off();
   /**
-   * @brief kill vibro_ticker after milliseconds
+   * @brief kill vibro_task after milliseconds
    * 
    * @param milliseconds 
    */
   void killAfter(uint32_t milliseconds);
 
-  Ticker vibro_ticker;
-  Ticker ticker_killer;
+  Task vibro_task = Task(TaskUI);
+  Task kill_task = Task(TaskUI);
   uint8_t _pin;
   bool tumbler = true;
 };
@@ -16,13 +16,18 @@
 
 #define USE_SERIAL Serial
 
-WebClient::WebClient(String bridge_id)
+void WebClient::begin(String bridge_id)
 {
     if (!bridge_id.length())
         bridge_id = "0";
     b_id = bridge_id;
     strcpy(ssid, ("mcs_" + bridge_id).c_str());
 
+    //Bound bridge is the only one until the bridge sends backups
+    memset(&bridges, 0, sizeof(bridges));
+    bridges.count = 1;
+    strcpy(bridges.bridge[0].ssid, ssid);
+
     WiFi.disconnect();
     WiFi.mode(WIFI_STA);
     WiFi.setAutoReconnect(true);
@@ -31,19 +36,45 @@ WebClient::WebClient(String bridge_id)
         Serial.println("WiFi connect");
         wifi_c = true;
         _wificonnect(e);
+    });
 
-        if (WiFi.gatewayIP() != INADDR_NONE)
-            ws_connect(WiFi.gatewayIP(), 80, "/ws");
-        else
-            ws_ticker.attach_ms<WebClient *>(500, [](WebClient *wc) {
-                if (WiFi.gatewayIP() != INADDR_NONE)
-                {
-                    Serial.println("Hi!");
-                    wc->ws_connect(WiFi.gatewayIP(), 80, "/ws");
-                    wc->ws_ticker.detach();
-                }
-            },
-                                             this);
+    //Gateway is known as soon as DHCP is done, connect ws right away
+    gotIPHandler = WiFi.onStationModeGotIP([&](const WiFiEventStationModeGotIP &e) {
+        Serial.print("WiFi got IP; gateway: ");
+        Serial.println(e.gw);
+        join_fast = false;
+        join_task.detach();
+
+        if (bind)
+        {
+            ws_connect(e.gw, 80, "/ws");
+            return;
+        }
+
+        //Learn BSSID and channel of the bridge for the next switch
+        BridgeInfo &bridge = bridges.bridge[bridge_index];
+        if (memcmp(bridge.bssid, WiFi.BSSID(), sizeof(bridge.bssid)) != 0 || bridge.channel != WiFi.channel())
+        {
+            memcpy(bridge.bssid, WiFi.BSSID(), sizeof(bridge.bssid));
+            bridge.channel = WiFi.channel();
+            if (_bridgesevent)
+                _bridgesevent(bridges);
+        }
+
+        //Remember the bound bridge, save only if something changed
+        if (bridge_index == 0)
+        {
+            bool changed = !join_valid ||
+                           memcmp(join.bssid, WiFi.BSSID(), sizeof(join.bssid)) != 0 ||
+                           join.channel != WiFi.channel();
+            memcpy(join.bssid, WiFi.BSSID(), sizeof(join.bssid));
+            join.channel = WiFi.channel();
+            join_valid = true;
+            if (changed && _joinevent)
+                _joinevent(join);
+        }
+
+        ws_connect(e.gw, 80, "/ws");
     });
 }
 
@@ -54,7 +85,35 @@ bool WebClient::isConnected()
 
 bool WebClient::isWS()
 {
-    webSocket.sendPing();
+    return webSocket.sendPingProbe();
+}
+
+uint8_t WebClient::rttStats(uint32_t &fastest, uint32_t &average, uint32_t &p99)
+{
+    fastest = average = p99 = 0;
+    if (!rtt_count)
+        return 0;
+
+    //Sorted copy, the window is small
+    uint32_t sorted[RTT_WINDOW];
+    uint64_t sum = 0;
+    for (uint8_t i = 0; i < rtt_count; ++i)
+    {
+        uint32_t v = rtt[i];
+        sum += v;
+        uint8_t pos = i;
+        while (pos > 0 && sorted[pos - 1] > v)
+        {
+            sorted[pos] = sorted[pos - 1];
+            --pos;
+        }
+        sorted[pos] = v;
+    }
+
+    fastest = sorted[0];
+    average = sum / rtt_count;
+    p99 = sorted[(rtt_count * 99 + 99) / 100 - 1];
+    return rtt_count;
 }
 
 void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
@@ -66,6 +125,9 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
         if (!ws_c)
             break;
 
+        if (!bind && !lost_time)
+            lost_time = millis() | 1;
+
         if (bind)
         {
             bind_next();
@@ -79,18 +141,32 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
     case WStype_CONNECTED:
         USE_SERIAL.printf("[WSc] Connected to url: %s\n", payload);
         ws_c = true;
-        ws_ticker.detach();
         if (bind)
-            web_ticker.detach();
+            web_task.detach();
         else
+        {
+            lost_time = 0;
             _connect();
+        }
         break;
+    case WStype_PONG:
+    {
+        uint32_t t = webSocket.pingRTT();
+        if (!t)
+            break;
+        rtt[rtt_index] = t;
+        rtt_index = (rtt_index + 1) % RTT_WINDOW;
+        if (rtt_count < RTT_WINDOW)
+            rtt_count++;
+        break;
+    }
     case WStype_TEXT:
     {
         USE_SERIAL.printf("[WSc] get text: %s\n", payload);
         break;
     }
     case WStype_BIN:
+    {
         USE_SERIAL.printf("[WSc] get binary length: %u\n", length);
         hexdump(payload, length);
         Serial.print("Get binary; length: ");
@@ -104,6 +180,12 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
             Serial.println();
         }
 
+        if (!length)
+            break;
+
+        //Command arguments, decoded by the handlers straight from the receive buffer
+        PayloadView args = {payload + 1, length - 1};
+
         switch (payload[0])
         {
         //Calibration command
@@ -114,12 +196,7 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
         //Vibration command
         case 0x5A:
             if (_vibroevent)
-            {
-                if (length > 1)
-                    _vibroevent(payload[1]);
-                else
-                    _vibroevent(0);
-            }
+                _vibroevent(args.at(0));
             break;
         //Start MoCap command
         case 0xB:
@@ -140,18 +217,12 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
         case 0x51:
             if (_changecolor)
             {
-                uint16_t c[6] = {0};
-
-                if (length > 3)
-                    for (int i = 0; i < 3; ++i)
-                        c[i] = payload[i + 1] * 4;
-                else
+                //First color is required, second only if complete
+                if (args.length < 3)
                     break;
 
-                if (length > 6)
-                    for (int i = 3; i < 6; ++i)
-                        c[i] = payload[i + 1] * 4;
-                _changecolor(c);
+                args.length = args.length < 6 ? 3 : 6;
+                _changecolor(args);
             }
             break;
         //Led enable command
@@ -164,6 +235,15 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
             if (_ledioevent)
                 _ledioevent(false);
             break;
+        //Link bounds command: max batch, max rate divider
+        case 0x5B:
+            if (_linkbounds)
+                _linkbounds(args);
+            break;
+        //Set backup bridges command
+        case 0x17:
+            set_backups(args);
+            break;
         //Alarm command
         case 0x59:
             if (_alarmevent)
@@ -173,6 +253,25 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
         case 0x14:
             sendBridgeID();
             break;
+        //Get RTT statistics command
+        case 0x18:
+            sendRTT();
+            break;
+        //Get boot report command
+        case 0x19:
+            if (_bootreport)
+                _bootreport();
+            break;
+        //Get scheduler stats command
+        case 0x1A:
+            if (_schedstats)
+                _schedstats();
+            break;
+        //Get stage histograms command
+        case 0x1B:
+            if (_profile)
+                _profile();
+            break;
         //Get MAC command
         case 0x15:
             Serial.println("Send MAC");
@@ -184,15 +283,25 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
             if (bind && _changessid)
             {
                 Serial.println("Accept bind command");
-                String ssid = WiFi.SSID();
+                const String &ssid = WiFi.SSID();
                 Serial.print("SSID: ");
                 Serial.println(ssid);
-                if (!ssid.startsWith("mcsbnd_") || !ssid.length() > 7)
+                if (!ssid.startsWith("mcsbnd_") || ssid.length() <= 7)
                     break;
-                b_id = ssid.substring(7);
-                strcpy(this->ssid, ("mcs_" + b_id).c_str());
+                b_id = ssid.c_str() + 7;
+                snprintf(this->ssid, sizeof(this->ssid), "mcs_%s", b_id.c_str());
                 _changessid(b_id);
                 bind = false;
+                scan_clear();
+                join_reset();
+
+                //New bound bridge, backups belong to the old one
+                memset(&bridges, 0, sizeof(bridges));
+                bridges.count = 1;
+                strcpy(bridges.bridge[0].ssid, this->ssid);
+                bridge_index = 0;
+                if (_bridgesevent)
+                    _bridgesevent(bridges);
                 _disconnect();
                 connect();
             }
@@ -208,14 +317,12 @@ void WebClient::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
             break;
             //Reset command
         case 0x96:
-        {
-            if (length > 1)
-                _restartevent(payload[1]);
-            else
-                _restartevent(0);
+            if (_restartevent)
+                _restartevent(args.at(0));
+            break;
         }
         break;
-        }
+    }
     }
 }
 
@@ -274,6 +381,152 @@ void WebClient::onRestart(IntEvent event)
     _restartevent = event;
 }
 
+void WebClient::onLinkBounds(PayloadEvent event)
+{
+    _linkbounds = event;
+}
+
+void WebClient::onBootReport(Event event)
+{
+    _bootreport = event;
+}
+
+void WebClient::onSchedStats(Event event)
+{
+    _schedstats = event;
+}
+
+void WebClient::onProfile(Event event)
+{
+    _profile = event;
+}
+
+void WebClient::onBridges(BridgesEvent event)
+{
+    _bridgesevent = event;
+}
+
+void WebClient::setBridges(const BridgeList &bridges)
+{
+    if (!bridges.count || bridges.count > BRIDGE_LIST_SIZE)
+        return;
+    if (strncmp(bridges.bridge[0].ssid, this->ssid, sizeof(this->ssid)) != 0)
+        return;
+
+    this->bridges = bridges;
+    for (uint8_t i = 0; i < BRIDGE_LIST_SIZE; ++i)
+        this->bridges.bridge[i].ssid[sizeof(BridgeInfo::ssid) - 1] = 0;
+}
+
+void WebClient::set_backups(const PayloadView &args)
+{
+    bridges.count = 1;
+    memset(&bridges.bridge[1], 0, (BRIDGE_LIST_SIZE - 1) * sizeof(BridgeInfo));
+
+    size_t i = 0;
+    while (bridges.count < BRIDGE_LIST_SIZE && i < args.length)
+    {
+        uint8_t len = args.at(i);
+        if (!len || len >= sizeof(BridgeInfo::ssid) || i + 1 + len + 7 > args.length)
+            break;
+
+        BridgeInfo &bridge = bridges.bridge[bridges.count++];
+        memcpy(bridge.ssid, args.data + i + 1, len);
+        memcpy(bridge.bssid, args.data + i + 1 + len, sizeof(bridge.bssid));
+        bridge.channel = args.at(i + 7 + len);
+        i += 8 + len;
+    }
+
+    Serial.print("Bridges: ");
+    Serial.println(bridges.count);
+
+    if (bridge_index >= bridges.count)
+        bridge_index = 0;
+    if (_bridgesevent)
+        _bridgesevent(bridges);
+}
+
+void WebClient::health()
+{
+    if (bind || millis() - health_time < BRIDGE_HEALTH_PERIOD)
+        return;
+    health_time = millis();
+
+    //Send queue never empties, the bridge is gone without closing the connection
+    if (!ws_c || !webSocket.sendQueueStats().entries)
+        stall_time = 0;
+    else if (!stall_time)
+        stall_time = millis() | 1;
+    else if (millis() - stall_time > BRIDGE_STALL_TIME)
+    {
+        Serial.println("Bridge stalled");
+        stall_time = 0;
+        bridge_next();
+        return;
+    }
+
+    //Probes not answered, also in the async build (no send queue there)
+    if (ws_c && webSocket.pingSilence() > BRIDGE_STALL_TIME)
+    {
+        Serial.println("Bridge silent");
+        stall_time = 0;
+        bridge_next();
+        return;
+    }
+
+    if (lost_time && millis() - lost_time > BRIDGE_FAILOVER_TIME)
+    {
+        Serial.println("Bridge lost");
+        bridge_next();
+    }
+}
+
+void WebClient::bridge_next()
+{
+    bool was_connected = ws_c;
+
+    bridge_index = (bridge_index + 1) % bridges.count;
+    const BridgeInfo &bridge = bridges.bridge[bridge_index];
+    Serial.print("Switch to bridge ");
+    Serial.print(bridge_index);
+    Serial.print(": ");
+    Serial.println(bridge.ssid);
+
+    wifi_c = ws_c = false;
+    WiFi.disconnect();
+    if (was_connected)
+        _disconnect();
+
+    strcpy(ssid, bridge.ssid);
+    lost_time = millis() | 1;
+
+    //Bound bridge: cached join if known
+    if (bridge_index == 0)
+    {
+        connect();
+        return;
+    }
+
+    //Backups always scan, the cached join stays for the bound bridge
+    join_task.detach();
+    join_fast = false;
+
+    static const uint8_t unknown[6] = {0};
+    bool known = memcmp(bridge.bssid, unknown, sizeof(unknown)) != 0;
+    connect(ssid, false, known ? bridge.channel : 0, known ? bridge.bssid : NULL);
+}
+
+void WebClient::onJoin(JoinEvent event)
+{
+    _joinevent = event;
+}
+
+void WebClient::setJoin(const JoinInfo &join)
+{
+    this->join = join;
+    join_valid = join.channel != 0;
+}
+
 void WebClient::onConnect(Event event)
 {
     _connect = event;
@@ -302,6 +555,26 @@ void WebClient::sendBin(uint8_t *buf, size_t length, uint8_t command)
     delete[] b;
 }
 
+bool WebClient::sendBinStream(WSstreamProducer producer, uint8_t command)
+{
+    if (!command)
+    {
+        return webSocket.sendBINStream(producer);
+    }
+
+    //Command byte goes in front of the first chunk
+    bool first = true;
+    return webSocket.sendBINStream([&](uint8_t *buffer, size_t size) -> size_t {
+        if (!first)
+        {
+            return producer(buffer, size);
+        }
+        first = false;
+        buffer[0] = command;
+        return producer(buffer + 1, size - 1) + 1;
+    });
+}
+
 void WebClient::sendTXT(String str)
 {
     webSocket.sendTXT(str);
@@ -322,12 +595,58 @@ void WebClient::sendBridgeID()
     sendBin(buf, 4);
 }
 
+void WebClient::sendRTT()
+{
+    //count, min, avg, p99 (us)
+    uint32_t stats[3];
+    uint8_t buf[1 + sizeof(stats)];
+    buf[0] = rttStats(stats[0], stats[1], stats[2]);
+    memcpy(buf + 1, stats, sizeof(stats));
+    sendBin(buf, sizeof(buf), RTT_STATS);
+}
+
 void WebClient::connect(bool bind_connection)
 {
-    connect(this->ssid, bind_connection);
+    if (!bind_connection && !lost_time)
+        lost_time = millis() | 1;
+
+    if (bind_connection || !join_valid)
+    {
+        connect(this->ssid, bind_connection);
+        return;
+    }
+
+    //Known bridge: no scan, address by DHCP
+    Serial.println("Fast join");
+    join_fast = true;
+    connect(this->ssid, false, join.channel, join.bssid);
+
+    join_task.once_ms(JOIN_TIMEOUT, [this]() {
+        join_fallback();
+    });
+}
+
+void WebClient::join_fallback()
+{
+    if (!join_fast)
+        return;
+
+    Serial.println("Fast join failed, scan");
+    join_reset();
+
+    //New join attempt, the scan join gets the full failover time
+    if (lost_time)
+        lost_time = millis() | 1;
+    connect(this->ssid);
+}
+
+void WebClient::join_reset()
+{
+    join_task.detach();
+    join_valid = join_fast = false;
 }
 
-void WebClient::connect(const char *ssid, bool bind_connection)
+void WebClient::connect(const char *ssid, bool bind_connection, int32_t channel, const uint8_t *bssid)
 {
     Serial.print("Connecting to ");
     Serial.println(ssid);
@@ -341,18 +660,16 @@ void WebClient::connect(const char *ssid, bool bind_connection)
             if (wifi_c)
             {
                 Serial.println("WiFi disconnect accepted");
-                ws_ticker.detach();
-                web_ticker.detach();
+                web_task.detach();
                 wifi_c = false;
                 bind_next();
             }
         });
 
-        web_ticker.once<WebClient *>(10, [](WebClient *wc) {
+        web_task.once_ms(10000, [this]() {
             Serial.println("Time is out");
-            wc->bind_next();
-        },
-                                     this);
+            bind_next();
+        });
     }
     else
     {
@@ -365,15 +682,27 @@ void WebClient::connect(const char *ssid, bool bind_connection)
             if (wifi_c)
             {
                 Serial.println("WiFi disconnect accepted 1");
-                ws_ticker.detach();
-                web_ticker.detach();
+                web_task.detach();
                 wifi_c = false;
                 ws_c = false;
                 _wifidisconnect(e);
+                if (!lost_time)
+                    lost_time = millis() | 1;
+
+                //Auto reconnect uses the cached BSSID / channel, scan if the bridge moved
+                if (join_valid && bridge_index == 0)
+                {
+                    join_fast = true;
+                    join_task.once_ms(JOIN_TIMEOUT, [this]() {
+                        join_fallback();
+                    });
+                }
             }
+            else if (join_fast && e.reason != WIFI_DISCONNECT_REASON_ASSOC_LEAVE)
+                join_fallback();
         });
     }
-    WiFi.begin(ssid);
+    WiFi.begin(ssid, NULL, channel, bssid);
 
     //WebSocet connection
     //webSocket.begin(ip, port, url);
@@ -388,51 +717,143 @@ void WebClient::ws_connect(IPAddress host, uint16_t port, const char *url)
                                 std::placeholders::_1,
                                 std::placeholders::_2,
                                 std::placeholders::_3));
-    webSocket.setReconnectInterval(5000);
+    //Retry fast after a dropout, back off while the bridge is away
+    webSocket.setReconnectInterval(RECONNECT_MIN_INTERVAL);
+    webSocket.setReconnectBackoff(RECONNECT_MAX_INTERVAL, RECONNECT_JITTER);
+    //Continuous latency signal, see rttStats
+    webSocket.setPingProbe(RTT_PROBE_INTERVAL);
+    // stale samples are useless, never let a slow link stall the loop
+    webSocket.setSendQueue(WEBSOCKETS_TX_QUEUE_DEPTH, SEND_QUEUE_MAX_AGE, WSqueue_dropOldest);
     Serial.print("ws_connect_end");
 }
 
-bool WebClient::bind_connection()
+/**
+ * @brief FNV-1a hash of a SSID
+ */
+static uint32_t ssid_hash(const char *ssid)
 {
-    Serial.println("bind_connection start");
-    int n = ssid_count = WiFi.scanNetworks(false, true);
-    String ssid = "";
-    //bool my_bind = false;
+    uint32_t hash = 2166136261UL;
+    while (*ssid)
+    {
+        hash ^= (uint8_t)*ssid++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
 
-    Serial.print("ssid_count: ");
-    Serial.println(ssid_count);
+void WebClient::scan_start()
+{
+    //Someone waits for the running scan again
+    if (scan_running)
+    {
+        scan_abandoned = false;
+        return;
+    }
+
+    scan_clear();
+    scan_running = true;
+    WiFi.scanNetworksAsync(std::bind(&WebClient::scan_done, this, std::placeholders::_1), true);
+}
+
+void WebClient::scan_done(int count)
+{
+    //Waiter timed out: free the late result
+    if (scan_abandoned)
+    {
+        scan_abandoned = false;
+        scan_running = false;
+        scan_clear();
+        return;
+    }
 
-    for (int i = 0; i < n; ++i)
+    uint32_t own_hash = ssid_hash(this->ssid);
+
+    ssid_count = 0;
+    for (int i = 0; i < count && i < 0xFF; ++i)
     {
-        ssid = WiFi.SSID(i);
-        if (strcmp(ssid.c_str(), this->ssid) == 0)
+        const String &ssid = WiFi.SSID(i);
+        ScanEntry entry;
+        entry.ssid_hash = ssid_hash(ssid.c_str());
+
+        if (entry.ssid_hash == own_hash)
         {
-            Serial.println("find my bridge");
-            Serial.println("bind_connection end");
-            return false;
+            scan_own = true;
+            continue;
         }
 
-        //  if (ssid == "mcsbnd_" + b_id)
-        //    my_bind = true;
+        if (ssid.length() <= BIND_PREFIX_LENGTH || !ssid.startsWith(BIND_PREFIX))
+            continue;
+
+        memcpy(entry.bssid, WiFi.BSSID(i), sizeof(entry.bssid));
+        entry.channel = WiFi.channel(i);
+        entry.rssi = WiFi.RSSI(i);
+        entry.index = i;
+
+        //Insert sorted by RSSI, the weakest falls out when full
+        int pos = ssid_count;
+        while (pos > 0 && scan_cache[pos - 1].rssi < entry.rssi)
+            --pos;
+        if (pos == SCAN_CACHE_SIZE)
+            continue;
+        int last = ssid_count < SCAN_CACHE_SIZE ? ssid_count : SCAN_CACHE_SIZE - 1;
+        memmove(&scan_cache[pos + 1], &scan_cache[pos], (last - pos) * sizeof(ScanEntry));
+        scan_cache[pos] = entry;
+        if (ssid_count < SCAN_CACHE_SIZE)
+            ssid_count++;
     }
 
-    for (i_ssid = 0; i_ssid < n; ++i_ssid)
+    scan_ready = true;
+    scan_running = false;
+}
+
+void WebClient::scan_clear()
+{
+    //Freed by scan_done when the scan ends
+    if (scan_running)
     {
-        ssid = WiFi.SSID(i_ssid);
+        scan_abandoned = true;
+        return;
+    }
 
-        if (ssid.length() > 7 && ssid.startsWith("mcsbnd_"))
-        {
-            bind = true;
-            i_ssid++;
-            _bndevent();
-            connect(ssid.c_str(), true);
-            Serial.println("bind_connection end");
-            return true;
-        }
+    WiFi.scanDelete();
+    scan_ready = scan_own = false;
+    ssid_count = i_ssid = 0;
+}
+
+bool WebClient::bind_connection()
+{
+    Serial.println("bind_connection start");
+
+    if (!scan_ready)
+        scan_start();
+
+    //Only the part of the scan not overlapped by the setup is waited for,
+    //LED and vibro effects go on meanwhile
+    unsigned long start = millis();
+    while (scan_running && millis() - start < SCAN_TIMEOUT)
+    {
+        Scheduler::Instance().run();
+        delay(1);
     }
 
+    Serial.print("ssid_count: ");
+    Serial.println(ssid_count);
+
+    if (scan_running || scan_own || !ssid_count)
+    {
+        if (scan_own)
+            Serial.println("find my bridge");
+        scan_clear();
+        Serial.println("bind_connection end");
+        return false;
+    }
+
+    bind = true;
+    i_ssid = 0;
+    _bndevent();
+    bind_next();
     Serial.println("bind_connection end");
-    return false;
+    return true;
 }
 
 void WebClient::bind_next()
@@ -444,31 +865,26 @@ void WebClient::bind_next()
     if (!bind)
         return;
 
-    String ssid;
-
-    for (; i_ssid < ssid_count; ++i_ssid)
+    if (i_ssid < ssid_count)
     {
-        ssid = WiFi.SSID(i_ssid);
-
-        if (ssid.length() > 7 && ssid.startsWith("mcsbnd_"))
-        {
-            Serial.print("ssid found: ");
-            Serial.println(ssid);
-            i_ssid++;
-            connect(ssid.c_str(), true);
-            Serial.println("bind_next end");
-            return;
-        }
+        const ScanEntry &entry = scan_cache[i_ssid++];
+        const String &ssid = WiFi.SSID(entry.index);
+        Serial.print("ssid found: ");
+        Serial.print(ssid);
+        Serial.print(" rssi: ");
+        Serial.println(entry.rssi);
+        //Channel and BSSID are known, no scan on connect
+        connect(ssid.c_str(), true, entry.channel, entry.bssid);
+        Serial.println("bind_next end");
+        return;
     }
 
-    if (i_ssid == ssid_count)
-    {
-        Serial.println("i_ssid == ssid_count");
-        bind = false;
-        wifi_c = ws_c = false;
-        WiFi.disconnect();
-        _disconnect();
-        connect();
-    }
+    Serial.println("i_ssid == ssid_count");
+    scan_clear();
+    bind = false;
+    wifi_c = ws_c = false;
+    WiFi.disconnect();
+    _disconnect();
+    connect();
     Serial.println("bind_next end");
-}
\ No newline at end of file
+}
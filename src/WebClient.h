@@ -15,7 +15,7 @@
 #include <WebSocketsClient.h>
 
 #include <WString.h>
-#include <Ticker.h>
+#include "Scheduler.h"
 
 #define BIND_BIN (uint8_t *)"bndcheck", 8
 
@@ -24,12 +24,118 @@
 #define COLORS 0x50
 #define BRIDGE_ID 0x14
 #define CALIBRATION_OFFSET 0x64
+#define LINK_STATE 0x1E
+#define RTT_STATS 0x18
+#define BOOT_REPORT 0x19
+#define SCHED_STATS 0x1A
+#define STAGE_PROFILE 0x1B
+
+//Max time (ms) a frame waits in the send queue before it is dropped
+#define SEND_QUEUE_MAX_AGE 250
+
+//WS reconnect backoff (ms): first retry, cap and jitter (%)
+#define RECONNECT_MIN_INTERVAL 250
+#define RECONNECT_MAX_INTERVAL 5000
+#define RECONNECT_JITTER 25
+
+//Bind scan: max cached bridges and max wait (ms) for the scan result
+#define SCAN_CACHE_SIZE 16
+#define SCAN_TIMEOUT 5000
+
+//Max wait (ms) for a join with the cached BSSID / channel before a full scan
+#define JOIN_TIMEOUT 3000
+
+//RTT probe: ping interval (ms) and RTT samples kept for the statistics
+#define RTT_PROBE_INTERVAL 1000
+#define RTT_WINDOW 64
+
+//Bridge failover: bridges in the list, switch after this time (ms) without ws
+//(counted from the start of the current join attempt)
+//or with frames queued all this time (bridge stalled), check period (ms)
+#define BRIDGE_LIST_SIZE 4
+#define BRIDGE_FAILOVER_TIME 4000
+#define BRIDGE_STALL_TIME 2000
+#define BRIDGE_HEALTH_PERIOD 500
+
+#define BIND_PREFIX "mcsbnd_"
+#define BIND_PREFIX_LENGTH 7
+
+/**
+ * @brief Read only view of received command arguments
+ *
+ * Points into the websocket receive buffer, no copy is made.
+ * Only valid while the handler runs, copy what has to be kept.
+ */
+struct PayloadView
+{
+  const uint8_t *data;
+  size_t length;
+
+  /**
+   * @brief Byte at index or default if the payload is shorter
+   */
+  uint8_t at(size_t i, uint8_t def = 0) const
+  {
+    return i < length ? data[i] : def;
+  }
+};
+
+/**
+ * @brief Bridge access point found by the bind scan
+ *
+ * The SSID itself stays in the scan result, it is only read to connect.
+ */
+struct ScanEntry
+{
+  uint32_t ssid_hash;
+  uint8_t bssid[6];
+  uint8_t channel;
+  int8_t rssi;
+  uint8_t index; //Position in the scan result
+};
+
+/**
+ * @brief Last good join to the bridge
+ *
+ * Saved after the node got an IP, the next join skips the scan.
+ * Only BSSID and channel are cached, the address always comes from DHCP
+ * (a lease is not reused, there is no static IP).
+ */
+struct JoinInfo
+{
+  uint8_t bssid[6];
+  uint8_t channel;
+};
+
+/**
+ * @brief Bridge of the failover list
+ *
+ * BSSID all 0 = unknown, found by scan on join.
+ */
+struct BridgeInfo
+{
+  char ssid[25];
+  uint8_t bssid[6];
+  uint8_t channel;
+};
+
+/**
+ * @brief Ranked bridges, first is the bound bridge
+ */
+struct BridgeList
+{
+  uint8_t count;
+  BridgeInfo bridge[BRIDGE_LIST_SIZE];
+};
 
 typedef std::function<void()> Event;
-typedef std::function<void(uint16_t (&f)[6])> ColorEvent;
+typedef std::function<void(const PayloadView &rgb)> ColorEvent;
+typedef std::function<void(const PayloadView &args)> PayloadEvent;
 typedef std::function<void(uint16_t number)> IntEvent;
 typedef std::function<void(bool flag)> BoolEvent;
-typedef std::function<void(String str)> StringEvent;
+typedef std::function<void(const String &str)> StringEvent;
+typedef std::function<void(const JoinInfo &join)> JoinEvent;
+typedef std::function<void(const BridgeList &bridges)> BridgesEvent;
 typedef std::function<void(const WiFiEventStationModeConnected &)> WiFiConnectedEvent;
 typedef std::function<void(const WiFiEventStationModeDisconnected &)> WiFiDisconnectedEvent;
 
@@ -40,13 +146,23 @@ public:
    * @brief Construct a new Web Client object
    * 
    */
-  WebClient(String bridge_id);
+  WebClient(){};
+
+  /**
+   * @brief Setup WiFi and its handlers
+   * 
+   * Not in the constructor, global objects are built before setup()
+   * 
+   * @param bridge_id ID of the bound bridge
+   */
+  void begin(String bridge_id);
 
   ~WebClient(){};
 
   void loop()
   {
     webSocket.loop();
+    health();
   }
 
   /**
@@ -61,13 +177,23 @@ public:
   /**
    * @brief Check is WebSocket connected
    * 
-   * Ping server
+   * Ping server with a RTT probe, the answer goes into the RTT statistics
    * 
    * @return true 
    * @return false 
    */
   bool isWS();
 
+  /**
+   * @brief RTT statistics of the last RTT_WINDOW probes (us)
+   * 
+   * @param fastest 
+   * @param average 
+   * @param p99 
+   * @return uint8_t number of samples
+   */
+  uint8_t rttStats(uint32_t &fastest, uint32_t &average, uint32_t &p99);
+
   /**
  * @brief Print WiFi status in Serial Monitor
  * 
@@ -80,7 +206,8 @@ public:
   /**
    * @brief Main ws event
    * 
-   * Get data, parse and call functions
+   * Get data, parse and call functions.
+   * Command arguments are passed to handlers as PayloadView
    * 
    * @param type 
    * @param payload 
@@ -115,6 +242,8 @@ public:
   /**
    * @brief Set handler for onColor event 
    * 
+   * Handler gets 3 or 6 raw 8 bit color values (first and second color)
+   * 
    * @param eventFunc 
    */
   void onColor(ColorEvent eventFunc);
@@ -162,6 +291,76 @@ public:
    */
   void onRestart(IntEvent eventFunc);
 
+  /**
+   * @brief Set handler for onLinkBounds event
+   * 
+   * Handler gets max batch size and max sample rate divider
+   * 
+   * @param eventFunc 
+   */
+  void onLinkBounds(PayloadEvent eventFunc);
+
+  /**
+   * @brief Set handler for onBootReport event
+   * 
+   * Bridge asks for the boot timings
+   * 
+   * @param eventFunc 
+   */
+  void onBootReport(Event eventFunc);
+
+  /**
+   * @brief Set handler for onSchedStats event
+   * 
+   * Bridge asks for the scheduler accounting
+   * 
+   * @param eventFunc 
+   */
+  void onSchedStats(Event eventFunc);
+
+  /**
+   * @brief Set handler for onProfile event
+   * 
+   * Bridge asks for the stage histograms
+   * 
+   * @param eventFunc 
+   */
+  void onProfile(Event eventFunc);
+
+  /**
+   * @brief Set handler for onBridges event
+   * 
+   * Called when the bridge list (or a learned BSSID / channel) changed, to save it
+   * 
+   * @param eventFunc 
+   */
+  void onBridges(BridgesEvent eventFunc);
+
+  /**
+   * @brief Set saved bridge list
+   * 
+   * Ignored if the first bridge is not the bound bridge
+   * 
+   * @param bridges 
+   */
+  void setBridges(const BridgeList &bridges);
+
+  /**
+   * @brief Set handler for onJoin event
+   * 
+   * Called when the join to the bridge (BSSID, channel) changed, to save it
+   * 
+   * @param eventFunc 
+   */
+  void onJoin(JoinEvent eventFunc);
+
+  /**
+   * @brief Set last good join for the next connect
+   * 
+   * @param join 
+   */
+  void setJoin(const JoinInfo &join);
+
   /**
    * @brief Set handler for onConnect event 
    * 
@@ -183,6 +382,33 @@ public:
    * @param length 
    */
   void sendBin(uint8_t *buf, size_t length, uint8_t command = 0x00);
+  /**
+   * @brief Send a big binary message (sample backlog, dump) to WS server (Bridge) in fragments
+   *
+   * Only one chunk is in RAM, the producer fills it until it returns less than asked.
+   *
+   * @param producer fills the next chunk
+   * @param command optional command byte in front of the data
+   * @return true if the whole message was sent
+   */
+  bool sendBinStream(WSstreamProducer producer, uint8_t command = 0x00);
+  /**
+   * @brief Frames waiting in the send queue, drops, age
+   * 
+   * Async build: ESPAsyncTCP buffers without a queue, the age is the
+   * unanswered probe time and a waiting probe counts as one frame
+   * 
+   * @return WSqueueStats_t 
+   */
+  WSqueueStats_t sendQueueStats()
+  {
+    WSqueueStats_t stats = webSocket.sendQueueStats();
+#if (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    stats.oldestAge = webSocket.pingSilence();
+    stats.entries = stats.oldestAge ? 1 : 0;
+#endif
+    return stats;
+  }
   /**
    * @brief Send text data to WS server (Bridge)
    * 
@@ -195,7 +421,7 @@ public:
    * 
    */
   void connect(bool bind_connection = false);
-  void connect(const char *ssid, bool bind_connection = false);
+  void connect(const char *ssid, bool bind_connection = false, int32_t channel = 0, const uint8_t *bssid = NULL);
 
   /**
    * @brief Begin websocket connection
@@ -206,9 +432,19 @@ public:
    */
   void ws_connect(IPAddress host, uint16_t port, const char *url = "/");
 
+  /**
+   * @brief Start the bind scan in background
+   * 
+   * Call early (before MPU setup), bind_connection only waits for the rest.
+   * 
+   */
+  void scan_start();
+
   /**
    * @brief Trying connect to Bridge AP (access point) in binding mode
    * 
+   * Uses the scan of scan_start, bind APs are tried strongest first.
+   * 
    * @return true 
    * @return false 
    */
@@ -224,7 +460,8 @@ public:
   int32_t bindStartTime;
 
 private:
-  Ticker web_ticker, ws_ticker;
+  Task web_task = Task(TaskNetwork);
+  Task join_task = Task(TaskNetwork);
 
   WebSocketsClient webSocket;
 
@@ -240,6 +477,59 @@ private:
    */
   void sendBridgeID();
 
+  /**
+   * @brief Send RTT statistics to ws server
+   * 
+   */
+  void sendRTT();
+
+  /**
+   * @brief Async scan done, fill the scan cache
+   * 
+   * An abandoned scan (scan_clear while running) is freed instead
+   * 
+   * @param count networks found
+   */
+  void scan_done(int count);
+
+  /**
+   * @brief Bridge health check, switch to the next bridge if it is lost
+   * 
+   */
+  void health();
+
+  /**
+   * @brief Switch to the next bridge of the list
+   * 
+   */
+  void bridge_next();
+
+  /**
+   * @brief Replace backup bridges from bridge command
+   * 
+   * @param args entries of [ssid length][ssid][bssid 6][channel]
+   */
+  void set_backups(const PayloadView &args);
+
+  /**
+   * @brief Fast join failed, forget it and join with scan and DHCP
+   * 
+   */
+  void join_fallback();
+
+  /**
+   * @brief Forget the cached join, back to DHCP
+   * 
+   */
+  void join_reset();
+
+  /**
+   * @brief Free scan result and cache
+   * 
+   * A running scan is marked abandoned and freed when it is done
+   */
+  void scan_clear();
+
   Event _bndevent;
   Event _startevent;
   Event _stopevent;
@@ -251,17 +541,44 @@ private:
   Event _getcolor;
   ColorEvent _changecolor;
   StringEvent _changessid;
+  PayloadEvent _linkbounds;
+  Event _bootreport;
+  Event _schedstats;
+  Event _profile;
+  BridgesEvent _bridgesevent;
+  JoinEvent _joinevent;
   Event _connect;
   WiFiConnectedEvent _wificonnect = [](const WiFiEventStationModeConnected &) {};
   Event _disconnect;
   WiFiDisconnectedEvent _wifidisconnect = [](const WiFiEventStationModeDisconnected &) {};
 
   WiFiEventHandler connectHandler;
+  WiFiEventHandler gotIPHandler;
   WiFiEventHandler disconnectHandler;
 
+  uint32_t rtt[RTT_WINDOW];
+  uint8_t rtt_count = 0;
+  uint8_t rtt_index = 0;
+
+  BridgeList bridges;
+  uint8_t bridge_index = 0;
+  unsigned long lost_time = 0; //millis() since the bridge is lost, 0 = ok
+  unsigned long stall_time = 0; //millis() since the send queue is not empty
+  unsigned long health_time = 0;
+
+  JoinInfo join;
+  bool join_valid = false;
+  bool join_fast = false;
+
   bool wifi_c = false;
   bool ws_c = false;
 
+  ScanEntry scan_cache[SCAN_CACHE_SIZE];
+  volatile bool scan_running = false;
+  volatile bool scan_abandoned = false; //nobody waits, scan_done frees the result
+  bool scan_ready = false;
+  bool scan_own = false;
+
   int ssid_count = 0;
   int i_ssid = 0;
 
@@ -0,0 +1,239 @@
+/**
+ * @brief Host test of the table driven state machine
+ *
+ * Guard and from columns, FSM_ANY rows in table order, internal transitions,
+ * refused dispatch from an action and the transition traces
+ *
+ * @file test_fsm.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "HostTest.h"
+
+#include "Fsm.h"
+
+#include <string>
+
+enum
+{
+    Idle,
+    Search,
+    Active,
+    Bind,
+    States
+};
+
+enum
+{
+    EvGo,
+    EvStop,
+    EvTick,
+    EvBind,
+    EvReset,
+    EvNested,
+    EvBroken,
+    EvUnknown
+};
+
+//Actions and hooks in the order they ran
+std::string steps;
+
+uint32_t now = 100;
+bool allow = false;
+bool nested = true;
+FsmTrace traced = {};
+uint8_t hooks = 0;
+
+uint32_t fakeClock()
+{
+    return now;
+}
+
+void enterIdle() { steps += "+Idle"; }
+void exitIdle() { steps += "-Idle"; }
+void enterSearch() { steps += "+Search"; }
+void exitSearch() { steps += "-Search"; }
+void enterActive()
+{
+    steps += "+Active";
+    //Transition takes time
+    now += 7;
+}
+void exitActive() { steps += "-Active"; }
+
+bool allowed() { return allow; }
+
+void actGo() { steps += "go"; }
+void actTick() { steps += "tick"; }
+void actAny() { steps += "any"; }
+void actSpecific() { steps += "specific"; }
+
+Fsm *machine = NULL;
+
+void actNested()
+{
+    steps += "nested";
+    nested = machine->dispatch(EvStop);
+}
+
+void hook(const FsmTrace &trace)
+{
+    traced = trace;
+    hooks++;
+}
+
+const FsmStateDef states[States] = {
+    {"Idle", enterIdle, exitIdle, 0},
+    {"Search", enterSearch, exitSearch, 1},
+    {"Active", enterActive, exitActive, 2},
+    {"Bind", NULL, NULL, 3},
+};
+
+const FsmTransition table[] = {
+    //Guard column: first row is skipped while the guard says no
+    {Idle, EvGo, Active, allowed, actGo},
+    {Idle, EvGo, Search, NULL, actGo},
+    //From column: only from Search
+    {Search, EvGo, Active, NULL, actGo},
+    {Active, EvStop, Idle, NULL, NULL},
+    //Internal transition
+    {Active, EvTick, Active, NULL, actTick},
+    //FSM_ANY before a specific row wins, after it only for the other states
+    {FSM_ANY, EvBind, Bind, NULL, actAny},
+    {Search, EvBind, Idle, NULL, actSpecific},
+    {Search, EvReset, Idle, NULL, actSpecific},
+    {FSM_ANY, EvReset, Search, NULL, actAny},
+    //Event from inside an action
+    {FSM_ANY, EvNested, Idle, NULL, actNested},
+    //Target out of the table
+    {FSM_ANY, EvBroken, States, NULL, NULL},
+};
+
+#define TRANSITIONS (sizeof(table) / sizeof(table[0]))
+
+void guards(Fsm &fsm)
+{
+    //Initial state: no entry action
+    CHECK_EQ(fsm.state(), Idle);
+    CHECK(steps.empty());
+    CHECK(!fsm.dispatch(EvUnknown));
+    CHECK(!fsm.dispatch(EvStop));
+
+    //Guard says no: next row
+    CHECK(fsm.dispatch(EvGo));
+    CHECK_EQ(fsm.state(), Search);
+    CHECK(steps == "-Idlego+Search");
+
+    //From Search, the Idle rows do not match
+    steps = "";
+    CHECK(fsm.dispatch(EvGo));
+    CHECK_EQ(fsm.state(), Active);
+    CHECK(steps == "-Searchgo+Active");
+
+    //Guard says yes: first row
+    CHECK(fsm.dispatch(EvStop));
+    allow = true;
+    steps = "";
+    CHECK(fsm.dispatch(EvGo));
+    CHECK_EQ(fsm.state(), Active);
+    CHECK(steps == "-Idlego+Active");
+    allow = false;
+}
+
+void internal(Fsm &fsm)
+{
+    FsmTrace last = fsm.last();
+    uint8_t count = hooks;
+
+    //Only the action, no exit / entry, no trace
+    steps = "";
+    CHECK(fsm.dispatch(EvTick));
+    CHECK_EQ(fsm.state(), Active);
+    CHECK(steps == "tick");
+    CHECK_EQ(hooks, count);
+    CHECK_EQ(fsm.last().at, last.at);
+    CHECK_EQ(fsm.last().event, last.event);
+}
+
+void any(Fsm &fsm)
+{
+    //FSM_ANY is the first row of EvBind, also from Search
+    fsm.dispatch(EvStop);
+    fsm.dispatch(EvGo);
+    CHECK_EQ(fsm.state(), Search);
+    steps = "";
+    CHECK(fsm.dispatch(EvBind));
+    CHECK_EQ(fsm.state(), Bind);
+    CHECK(steps == "-Searchany");
+
+    //Specific row of EvReset is first, FSM_ANY for the rest
+    CHECK(fsm.dispatch(EvReset));
+    CHECK_EQ(fsm.state(), Search);
+    steps = "";
+    CHECK(fsm.dispatch(EvReset));
+    CHECK_EQ(fsm.state(), Idle);
+    CHECK(steps == "-Searchspecific+Idle");
+}
+
+void nestedDispatch(Fsm &fsm)
+{
+    fsm.dispatch(EvGo);
+    fsm.dispatch(EvGo);
+    CHECK_EQ(fsm.state(), Active);
+
+    //EvStop from the action is refused, the outer transition completes
+    steps = "";
+    CHECK(fsm.dispatch(EvNested));
+    CHECK(!nested);
+    CHECK_EQ(fsm.state(), Idle);
+    CHECK(steps == "-Activenested+Idle");
+
+    //Not busy afterwards
+    CHECK(fsm.dispatch(EvGo));
+    CHECK_EQ(fsm.state(), Search);
+}
+
+void broken(Fsm &fsm)
+{
+    //Target out of the table: refused, state stays
+    steps = "";
+    CHECK(!fsm.dispatch(EvBroken));
+    CHECK_EQ(fsm.state(), Search);
+    CHECK(steps.empty());
+}
+
+void traces(Fsm &fsm)
+{
+    uint8_t count = hooks;
+    now = 1000;
+    CHECK(fsm.dispatch(EvGo));
+    CHECK_EQ(hooks, count + 1);
+    CHECK_EQ(traced.from, Search);
+    CHECK_EQ(traced.to, Active);
+    CHECK_EQ(traced.event, EvGo);
+    CHECK_EQ(traced.at, 1000);
+    //Entry of Active takes 7
+    CHECK_EQ(traced.duration, 7);
+    CHECK_EQ(fsm.last().at, traced.at);
+    CHECK_EQ(fsm.last().duration, traced.duration);
+
+    CHECK_EQ(fsm.def().data, 2);
+    CHECK(std::string(fsm.name(Active)) == "Active");
+    CHECK(std::string(fsm.name(States)) == "?");
+}
+
+int main()
+{
+    Fsm fsm(states, States, table, TRANSITIONS, Idle, fakeClock);
+    machine = &fsm;
+    fsm.onTransition(hook);
+
+    guards(fsm);
+    internal(fsm);
+    any(fsm);
+    nestedDispatch(fsm);
+    broken(fsm);
+    traces(fsm);
+
+    return hostTestResult();
+}
@@ -0,0 +1,130 @@
+/**
+ * @brief Host test of the stage histograms
+ *
+ * Bucket edges (255 / 256, 2^22 and above), saturation of a bucket at 0xFFFF,
+ * the write() layout of the STAGE_PROFILE report and the text dump, which is
+ * printed like on the serial console
+ *
+ * @file test_histogram.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "HostTest.h"
+
+#include "Histogram.h"
+
+#include <string>
+
+std::string text;
+
+void collect(const char *line)
+{
+    text += line;
+    fputs(line, stdout);
+}
+
+void edges()
+{
+    Histogram h;
+    h.add(0);
+    h.add(255);
+    CHECK_EQ(h.bucket(0), 2);
+
+    //Bucket i: [2^(7 + i), 2^(8 + i))
+    h.add(256);
+    h.add(511);
+    CHECK_EQ(h.bucket(1), 2);
+    h.add(512);
+    CHECK_EQ(h.bucket(2), 1);
+
+    //Last bucket from 2^22 up
+    h.add((1UL << 22) - 1);
+    CHECK_EQ(h.bucket(HIST_BUCKETS - 2), 1);
+    h.add(1UL << 22);
+    h.add(1UL << 31);
+    h.add(0xFFFFFFFF);
+    CHECK_EQ(h.bucket(HIST_BUCKETS - 1), 3);
+
+    CHECK_EQ(h.count(), 9);
+    CHECK_EQ(h.longest(), 0xFFFFFFFF);
+
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < HIST_BUCKETS; ++i)
+        sum += h.bucket(i);
+    CHECK_EQ(sum, h.count());
+
+    h.reset();
+    CHECK_EQ(h.count(), 0);
+    CHECK_EQ(h.longest(), 0);
+    CHECK_EQ(h.bucket(0), 0);
+}
+
+void saturation()
+{
+    Histogram h;
+    for (uint32_t i = 0; i < 0x10000 + 10; ++i)
+        h.add(300);
+    //Bucket stops, the count goes on
+    CHECK_EQ(h.bucket(1), 0xFFFF);
+    CHECK_EQ(h.count(), 0x10000 + 10);
+    CHECK_EQ(h.longest(), 300);
+}
+
+void layout()
+{
+    Histogram h;
+    h.add(100);
+    h.add(1000);
+    h.add(1000);
+    h.add(70000);
+
+    //count, max (4 bytes each), buckets (2 bytes each), little endian
+    uint8_t buf[HIST_SIZE + 1];
+    memset(buf, 0xAA, sizeof(buf));
+    h.write(buf);
+    CHECK_EQ(HIST_SIZE, 8 + 2 * HIST_BUCKETS);
+
+    const uint8_t head[8] = {4, 0, 0, 0, 0x70, 0x11, 0x01, 0x00};
+    CHECK(memcmp(buf, head, sizeof(head)) == 0);
+    for (uint8_t i = 0; i < HIST_BUCKETS; ++i)
+    {
+        uint16_t bucket = buf[8 + 2 * i] | (buf[9 + 2 * i] << 8);
+        CHECK_EQ(bucket, h.bucket(i));
+    }
+    //1000: [2^9, 2^10), 70000: [2^16, 2^17)
+    CHECK_EQ(buf[8 + 2 * 0], 1);
+    CHECK_EQ(buf[8 + 2 * 2], 2);
+    CHECK_EQ(buf[8 + 2 * 9], 1);
+    //Nothing written past HIST_SIZE
+    CHECK_EQ(buf[HIST_SIZE], 0xAA);
+}
+
+void dump()
+{
+    Histogram h;
+    h.add(10);
+    h.add(300);
+    h.add(300);
+    h.add(1UL << 23);
+    h.dump("Loop", collect);
+    CHECK(text == "Stage Loop: 4 runs, max 8388608 cycles\n"
+                  "  < 2^8: 1\n"
+                  "  < 2^9: 2\n"
+                  "  >= 2^22: 1\n");
+
+    //Empty: header only
+    text = "";
+    Histogram empty;
+    empty.dump("Send", collect);
+    CHECK(text == "Stage Send: 0 runs, max 0 cycles\n");
+}
+
+int main()
+{
+    edges();
+    saturation();
+    layout();
+    dump();
+
+    return hostTestResult();
+}
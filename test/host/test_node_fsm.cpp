@@ -0,0 +1,175 @@
+/**
+ * @brief Host test of the node transition table
+ *
+ * The real rows of NodeFsm.cpp with recording actions: events accepted per
+ * state, exit / entry actions, internal transitions and radio profiles
+ *
+ * @file test_node_fsm.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "HostTest.h"
+
+#include "NodeFsm.h"
+
+#include <string>
+
+//Actions in the order they ran
+std::string steps;
+
+uint32_t now = 0;
+uint8_t hooks = 0;
+
+uint32_t fakeClock()
+{
+    return now;
+}
+
+void hook(const FsmTrace &)
+{
+    hooks++;
+}
+
+void blueBlink() { steps += "blink "; }
+void crossFade() { steps += "fade "; }
+void ledCalibration() { steps += "calibration "; }
+void exitBind() { steps += "-bind "; }
+void exitSearch() { steps += "vibration "; }
+void startStream() { steps += "stream "; }
+void enterActive() { steps += "+active "; }
+void exitActive() { steps += "-active "; }
+
+Fsm machine(State initial)
+{
+    Fsm fsm(node_states, NodeStates, node_transitions, node_transition_count, initial, fakeClock);
+    fsm.onTransition(hook);
+    steps = "";
+    return fsm;
+}
+
+/**
+ * @brief States an event is accepted from
+ *
+ * @return bit per state
+ */
+uint8_t acceptedFrom(StateEvent event)
+{
+    uint8_t from = 0;
+    for (uint8_t s = 0; s < NodeStates; ++s)
+    {
+        Fsm fsm = machine((State)s);
+        if (fsm.dispatch(event))
+            from |= 1 << s;
+    }
+    return from;
+}
+
+void accepted()
+{
+    CHECK_EQ(acceptedFrom(EvBind), (1 << Undef) | (1 << Search));
+    CHECK_EQ(acceptedFrom(EvStart), 1 << Standby);
+    CHECK_EQ(acceptedFrom(EvCalibrate), 1 << Standby);
+    CHECK_EQ(acceptedFrom(EvSearch), 1 << Undef);
+    CHECK_EQ(acceptedFrom(EvDisconnect), (1 << NodeStates) - 1);
+    CHECK_EQ(acceptedFrom(EvConnect), (1 << NodeStates) - 1);
+    CHECK_EQ(acceptedFrom(EvStop), (1 << NodeStates) - 1);
+}
+
+void disconnect()
+{
+    //Search again: internal, no exit vibration, no blink
+    Fsm fsm = machine(Search);
+    hooks = 0;
+    CHECK(fsm.dispatch(EvDisconnect));
+    CHECK_EQ(fsm.state(), Search);
+    CHECK(steps.empty());
+    CHECK_EQ(hooks, 0);
+
+    //First search after boot: no blink
+    fsm = machine(Undef);
+    CHECK(fsm.dispatch(EvDisconnect));
+    CHECK_EQ(fsm.state(), Search);
+    CHECK(steps.empty());
+
+    //Lost while streaming
+    fsm = machine(Active);
+    CHECK(fsm.dispatch(EvDisconnect));
+    CHECK_EQ(fsm.state(), Search);
+    CHECK(steps == "-active blink ");
+
+    //Found again: vibration once
+    steps = "";
+    CHECK(fsm.dispatch(EvConnect));
+    CHECK_EQ(fsm.state(), Standby);
+    CHECK(steps == "vibration fade ");
+}
+
+void connect()
+{
+    //Standby again: only the cross fade, no exit / entry, no trace
+    Fsm fsm = machine(Standby);
+    hooks = 0;
+    CHECK(fsm.dispatch(EvConnect));
+    CHECK_EQ(fsm.state(), Standby);
+    CHECK(steps == "fade ");
+    CHECK_EQ(hooks, 0);
+}
+
+void session()
+{
+    Fsm fsm = machine(Undef);
+    CHECK(fsm.dispatch(EvBind));
+    CHECK_EQ(fsm.state(), Bind);
+    CHECK(steps == "fade ");
+
+    steps = "";
+    CHECK(fsm.dispatch(EvConnect));
+    CHECK(steps == "-bind fade ");
+
+    steps = "";
+    CHECK(fsm.dispatch(EvStart));
+    CHECK_EQ(fsm.state(), Active);
+    CHECK(steps == "stream +active ");
+    CHECK(!fsm.dispatch(EvStart));
+    CHECK(!fsm.dispatch(EvBind));
+
+    steps = "";
+    CHECK(fsm.dispatch(EvStop));
+    CHECK_EQ(fsm.state(), Standby);
+    CHECK(steps == "-active ");
+
+    steps = "";
+    CHECK(fsm.dispatch(EvCalibrate));
+    CHECK_EQ(fsm.state(), Calibration);
+    CHECK(steps == "calibration ");
+}
+
+void radio()
+{
+    CHECK_EQ(node_states[Active].data, RadioNoSleep);
+    CHECK_EQ(node_states[Bind].data, RadioNoSleep);
+    CHECK_EQ(node_states[Standby].data, RadioLightSleep);
+    CHECK_EQ(node_states[Search].data, RadioLightSleep);
+    CHECK_EQ(node_states[Undef].data, RadioModemSleep);
+    CHECK_EQ(node_states[Calibration].data, RadioModemSleep);
+}
+
+int main()
+{
+    //Nothing injected: the rows still run
+    Fsm fsm = machine(Undef);
+    CHECK(fsm.dispatch(EvBind));
+    CHECK(steps.empty());
+
+    const NodeActions actions = {blueBlink, crossFade, ledCalibration, exitBind,
+                                 exitSearch, startStream, enterActive, exitActive};
+    nodeActions(actions);
+
+    accepted();
+    disconnect();
+    connect();
+    session();
+    radio();
+
+    return hostTestResult();
+}
@@ -0,0 +1,71 @@
+/**
+ * @brief Host test of the scheduler intervals
+ *
+ * Long intervals are clamped to SCHED_MAX_INTERVAL, they neither overflow
+ * nor look overdue to the signed due compare
+ *
+ * @file test_scheduler.cpp
+ * @author Arseniy Churin
+ * @date 2026-10-19
+ */
+#include "HostTest.h"
+
+#include "Scheduler.h"
+
+uint8_t runs = 0;
+
+void count()
+{
+    runs++;
+}
+
+void once(uint32_t milliseconds)
+{
+    Scheduler &scheduler = Scheduler::Instance();
+    Task task(TaskNetwork);
+    runs = 0;
+    task.once_ms(milliseconds, count);
+
+    scheduler.run();
+    CHECK_EQ(runs, 0);
+    hostAdvanceMillis(SCHED_MAX_INTERVAL - 1);
+    scheduler.run();
+    CHECK_EQ(runs, 0);
+    hostAdvanceMillis(1);
+    scheduler.run();
+    CHECK_EQ(runs, 1);
+    CHECK(!task.active());
+}
+
+void periodic()
+{
+    Scheduler &scheduler = Scheduler::Instance();
+    Task task(TaskUI);
+    runs = 0;
+    task.attach_ms(3UL * 3600 * 1000, count);
+
+    for (uint8_t i = 1; i <= 3; ++i)
+    {
+        scheduler.run();
+        CHECK_EQ(runs, i - 1);
+        hostAdvanceMillis(SCHED_MAX_INTERVAL);
+        scheduler.run();
+        CHECK_EQ(runs, i);
+    }
+    task.detach();
+}
+
+int main()
+{
+    //Longest without clamping
+    once(SCHED_MAX_INTERVAL);
+    //2^31 us and more: looked overdue
+    once(SCHED_MAX_INTERVAL + 1);
+    once(40UL * 60 * 1000);
+    //ms * 1000 overflows 32 bit
+    once(3UL * 3600 * 1000);
+    once(0xFFFFFFFF);
+    periodic();
+
+    return hostTestResult();
+}